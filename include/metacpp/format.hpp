@@ -0,0 +1,202 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef METACPP_FORMAT_HPP
+#define METACPP_FORMAT_HPP 1
+
+/**
+ * @defgroup Format Formatting of reflected types
+ * @{
+ */
+
+#include "meta.hpp"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace metapp{
+	/**
+	 * @brief How `fmt::formatter` prints reflected values.
+	 *
+	 * - `compact` (`{}` or `{:c}`): `{x=1, y=2, c=red}`
+	 * - `verbose` (`{:v}`): `point{x=1, y=2, c=color::red, label="text"}`
+	 */
+	enum class format_mode{
+		compact, verbose
+	};
+
+	namespace detail{
+		template<typename T>
+		struct is_format_optional: std::false_type{};
+
+		template<typename T>
+		struct is_format_optional<std::optional<T>>: std::true_type{};
+
+		template<typename T, typename = void>
+		struct is_format_range: std::false_type{};
+
+		template<typename T>
+		struct is_format_range<T, std::void_t<decltype(std::begin(std::declval<const T&>()), std::end(std::declval<const T&>()))>>: std::true_type{};
+
+		template<typename OutputIt>
+		OutputIt format_str(OutputIt out, std::string_view str){
+			return std::copy(str.begin(), str.end(), out);
+		}
+
+		template<typename T, typename OutputIt>
+		OutputIt format_value(OutputIt out, const T &val, format_mode mode);
+
+		template<typename Class, typename OutputIt, std::size_t ... Is>
+		OutputIt format_members(OutputIt out, const Class &val, format_mode mode, std::index_sequence<Is...>){
+			using members = metapp::members<Class>;
+
+			bool first = true;
+
+			const auto format_member = [&](auto member){
+				using member_info = decltype(member);
+
+				if constexpr(member_info::is_accessable){
+					if(!first) out = format_str(out, ", ");
+					first = false;
+
+					out = format_str(out, member_info::name);
+					*out++ = '=';
+					out = format_value(out, member_info::get(val), mode);
+				}
+			};
+
+			(format_member(metapp::get_t<members, Is>{}), ...);
+			return out;
+		}
+
+		template<typename T, typename OutputIt>
+		OutputIt format_value(OutputIt out, const T &val, format_mode mode){
+			if constexpr(std::is_same_v<T, bool>){
+				return format_str(out, val ? "true" : "false");
+			}
+			else if constexpr(std::is_arithmetic_v<T>){
+				return fmt::format_to(out, "{}", val);
+			}
+			else if constexpr(std::is_enum_v<T>){
+				if constexpr(metapp::has_enum_info<T>){
+					const auto name = metapp::find_value_name(val);
+					if(!name.empty()){
+						if(mode == format_mode::verbose){
+							out = format_str(out, metapp::enum_info<T>::name);
+							out = format_str(out, "::");
+						}
+
+						return format_str(out, name);
+					}
+				}
+
+				// enums without reflection info and values without a name, like combined flags, print as numbers
+				return fmt::format_to(out, "{}", static_cast<std::underlying_type_t<T>>(val));
+			}
+			else if constexpr(std::is_convertible_v<const T&, std::string_view>){
+				if(mode == format_mode::verbose){
+					return fmt::format_to(out, "\"{}\"", std::string_view(val));
+				}
+
+				return format_str(out, val);
+			}
+			else if constexpr(is_format_optional<T>::value){
+				if(!val) return format_str(out, "none");
+				return format_value(out, *val, mode);
+			}
+			else if constexpr(metapp::has_info<T>){
+				if(mode == format_mode::verbose){
+					out = format_str(out, metapp::class_info<T>::name);
+				}
+
+				*out++ = '{';
+				out = format_members(out, val, mode, std::make_index_sequence<metapp::members<T>::size>());
+				*out++ = '}';
+				return out;
+			}
+			else if constexpr(is_format_range<T>::value){
+				*out++ = '[';
+
+				bool first = true;
+				for(auto &&elem : val){
+					if(!first) out = format_str(out, ", ");
+					first = false;
+					out = format_value(out, elem, mode);
+				}
+
+				*out++ = ']';
+				return out;
+			}
+			else if constexpr(fmt::is_formattable<T>::value){
+				return fmt::format_to(out, "{}", val);
+			}
+			else{
+				*out++ = '<';
+				out = format_str(out, metapp::type_name<T>);
+				*out++ = '>';
+				return out;
+			}
+		}
+	}
+}
+
+namespace metapp::detail{
+	template<typename T>
+	struct reflected_formatter{
+		format_mode mode = format_mode::compact;
+
+		constexpr auto parse(fmt::format_parse_context &ctx) -> decltype(ctx.begin()){
+			auto it = ctx.begin();
+			const auto end = ctx.end();
+
+			if(it != end && (*it == 'c' || *it == 'v')){
+				mode = *it++ == 'v' ? format_mode::verbose : format_mode::compact;
+			}
+
+			if(it != end && *it != '}'){
+				throw fmt::format_error("invalid format spec for reflected type");
+			}
+
+			return it;
+		}
+
+		template<typename FormatContext>
+		auto format(const T &val, FormatContext &ctx) const -> decltype(ctx.out()){
+			return format_value(ctx.out(), val, mode);
+		}
+	};
+}
+
+namespace fmt{
+	/**
+	 * @brief Formatter for every class with reflection info, printing `{name=value, ...}`.
+	 * @see metapp::format_mode for the accepted format specs
+	 */
+	template<typename T>
+	struct formatter<T, char, std::enable_if_t<metapp::has_info<T>>>: metapp::detail::reflected_formatter<T>{};
+
+	/**
+	 * @brief Formatter for every enum with reflection info, printing the name of the value.
+	 * @see metapp::format_mode for the accepted format specs
+	 */
+	template<typename T>
+	struct formatter<T, char, std::enable_if_t<metapp::has_enum_info<T>>>: metapp::detail::reflected_formatter<T>{};
+}
+
+/**
+ * @}
+ */
+
+#endif // !METACPP_FORMAT_HPP
@@ -0,0 +1,658 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef METACPP_LOG_HPP
+#define METACPP_LOG_HPP 1
+
+/**
+ * @defgroup Log Deferred formatting binary logging
+ * @warning These features are currently experimental.
+ * @{
+ */
+
+#include "meta.hpp"
+#include "refl.hpp"
+
+#include "fmt/format.h"
+#include "fmt/args.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace serialpp{
+	/**
+	 * @brief Single producer, single consumer ring of variable sized records.
+	 *
+	 * The producer reserves space for a record, fills it and commits it; the consumer reads committed
+	 * records in order. Neither side takes a lock.
+	 */
+	class log_ring{
+		public:
+			/**
+			 * @param capacity bytes in the ring, rounded up to a power of two
+			 */
+			explicit log_ring(std::size_t capacity){
+				std::size_t size = 64;
+				while(size < capacity) size <<= 1;
+
+				m_data.reset(new std::uint64_t[size / sizeof(std::uint64_t)]);
+				m_capacity = size;
+			}
+
+			std::size_t capacity() const noexcept{ return m_capacity; }
+
+			/**
+			 * @brief Reserve space for a record of `size` bytes, to be followed by `commit`.
+			 * @returns `nullptr` if the ring is too full
+			 */
+			void *reserve(std::size_t size) noexcept{
+				const auto total = record_size(size);
+				if(total > m_capacity / 2) return nullptr;
+
+				auto head = m_head.load(std::memory_order_relaxed);
+				const auto offset = head & (m_capacity - 1);
+				const auto contiguous = m_capacity - offset;
+				const auto needed = total > contiguous ? contiguous + total : total;
+
+				if(m_capacity - (head - m_cached_tail) < needed){
+					m_cached_tail = m_tail.load(std::memory_order_acquire);
+					if(m_capacity - (head - m_cached_tail) < needed) return nullptr;
+				}
+
+				if(total > contiguous){
+					// records never wrap, a zero sized header sends the consumer back to the start
+					write_header(offset, 0);
+					head += contiguous;
+				}
+
+				m_pending_head = head;
+				m_pending_size = total;
+				return bytes() + (head & (m_capacity - 1)) + header_size;
+			}
+
+			/**
+			 * @brief Publish the record returned by the last `reserve`.
+			 */
+			void commit() noexcept{
+				write_header(m_pending_head & (m_capacity - 1), m_pending_size);
+				m_head.store(m_pending_head + m_pending_size, std::memory_order_release);
+			}
+
+			/**
+			 * @brief Call `fn(const void *record, std::size_t size)` for every committed record.
+			 * @returns number of records consumed
+			 */
+			template<typename Fn>
+			std::size_t consume(Fn &&fn){
+				auto tail = m_tail.load(std::memory_order_relaxed);
+				const auto head = m_head.load(std::memory_order_acquire);
+
+				std::size_t ret = 0;
+
+				while(tail != head){
+					const auto offset = tail & (m_capacity - 1);
+
+					std::uint64_t size;
+					std::memcpy(&size, bytes() + offset, header_size);
+
+					if(size == 0){
+						tail += m_capacity - offset;
+						continue;
+					}
+
+					fn(static_cast<const void*>(bytes() + offset + header_size), static_cast<std::size_t>(size - header_size));
+					tail += size;
+					++ret;
+
+					m_tail.store(tail, std::memory_order_release);
+				}
+
+				m_tail.store(tail, std::memory_order_release);
+				return ret;
+			}
+
+		private:
+			static constexpr std::size_t header_size = sizeof(std::uint64_t);
+
+			static constexpr std::size_t record_size(std::size_t size) noexcept{
+				return (size + header_size + 7) & ~std::size_t(7);
+			}
+
+			unsigned char *bytes() noexcept{ return reinterpret_cast<unsigned char*>(m_data.get()); }
+
+			void write_header(std::size_t offset, std::uint64_t size) noexcept{
+				std::memcpy(bytes() + offset, &size, header_size);
+			}
+
+			std::unique_ptr<std::uint64_t[]> m_data;
+			std::size_t m_capacity;
+
+			alignas(64) std::atomic<std::uint64_t> m_head = 0;
+			std::uint64_t m_cached_tail = 0, m_pending_head = 0, m_pending_size = 0;
+
+			alignas(64) std::atomic<std::uint64_t> m_tail = 0;
+	};
+
+	namespace detail{
+		struct log_record_header{
+			const char *format;
+			std::uint32_t format_size;
+			std::uint32_t num_args;
+		};
+
+		struct log_arg_header{
+			std::uint64_t type_id;
+			std::uint64_t size;
+		};
+
+		// strings are copied as characters rather than as a `std::string_view`
+		inline constexpr std::uint64_t log_string_id = metapp::type_id<std::string_view>;
+
+		// the registry reflects `bool` as an 8-bit integer, so it gets an id of its own
+		inline constexpr std::uint64_t log_bool_id = metapp::type_id<bool>;
+
+		template<typename T>
+		std::uint64_t log_type_id(){
+			if constexpr(std::is_same_v<T, bool>){
+				return log_bool_id;
+			}
+			else{
+				// reflecting the type also makes sure the decoder can find it by id
+				return refl::reflect<T>()->id();
+			}
+		}
+
+		template<typename T>
+		constexpr bool is_log_string = std::is_convertible_v<const T&, std::string_view>;
+
+		template<typename T>
+		constexpr bool is_loggable =
+			is_log_string<T> ||
+			(std::is_arithmetic_v<T> && !std::is_same_v<T, long double>) ||
+			(std::is_enum_v<T> && metapp::has_enum_info<T>) ||
+			(metapp::has_info<T> && std::is_trivially_copyable_v<T>);
+
+		template<typename T>
+		std::size_t log_arg_size(const T &arg) noexcept{
+			if constexpr(is_log_string<T>){
+				return sizeof(log_arg_header) + std::string_view(arg).size();
+			}
+			else{
+				return sizeof(log_arg_header) + sizeof(T);
+			}
+		}
+
+		template<typename T>
+		unsigned char *write_log_arg(unsigned char *out, const T &arg) noexcept{
+			log_arg_header header;
+			const void *data;
+
+			if constexpr(is_log_string<T>){
+				const std::string_view str = arg;
+				header = { log_string_id, str.size() };
+				data = str.data();
+			}
+			else{
+				static const auto type_id = log_type_id<T>();
+
+				header = { type_id, sizeof(T) };
+				data = std::addressof(arg);
+			}
+
+			std::memcpy(out, &header, sizeof(header));
+			if(header.size) std::memcpy(out + sizeof(header), data, header.size);
+			return out + sizeof(header) + header.size;
+		}
+
+		inline void format_reflected(fmt::memory_buffer &out, refl::type_info type, const void *p, unsigned depth = 0);
+
+		inline void format_reflected_class(fmt::memory_buffer &out, refl::class_info cls, const void *p, unsigned depth){
+			out.push_back('{');
+
+			for(std::size_t i = 0; i < cls->num_members(); i++){
+				const auto member = cls->member(i);
+				const auto name = member->name();
+
+				if(i > 0) out.append(std::string_view(", "));
+				out.append(name);
+				out.push_back('=');
+
+				const auto member_p = member->get(const_cast<void*>(p));
+				if(member_p) format_reflected(out, member->type(), member_p, depth + 1);
+				else out.append(std::string_view("<?>"));
+			}
+
+			out.push_back('}');
+		}
+
+		inline void format_reflected_enum(fmt::memory_buffer &out, refl::enum_info info, const void *p){
+			std::uint64_t bits = 0;
+			const auto size = std::min<std::size_t>(info->size(), sizeof(bits));
+			std::memcpy(&bits, p, size);
+
+			const auto mask = size < 8 ? (std::uint64_t(1) << (size * 8)) - 1 : ~std::uint64_t(0);
+
+			for(std::size_t i = 0; i < info->num_values(); i++){
+				const auto value = info->value(i);
+				if((value->value() & mask) == bits){
+					out.append(value->name());
+					return;
+				}
+			}
+
+			fmt::format_to(std::back_inserter(out), "{}", bits);
+		}
+
+		template<typename T, typename Fn>
+		void visit_reflected_scalar(const void *p, Fn &&fn){
+			T val;
+			std::memcpy(&val, p, sizeof(T));
+			std::forward<Fn>(fn)(val);
+		}
+
+		/**
+		 * @brief Call `fn` with the value of a number only known through its runtime type, as its native type.
+		 * @returns `false` if the number has no matching native type
+		 */
+		template<typename Fn>
+		bool visit_reflected_num(refl::num_info num, const void *p, Fn &&fn){
+			const auto size = num->size();
+
+			if(num->is_floating_point()){
+				if(size == sizeof(float)) visit_reflected_scalar<float>(p, fn);
+				else if(size == sizeof(double)) visit_reflected_scalar<double>(p, fn);
+				else return false;
+			}
+			else if(dynamic_cast<refl::int_info>(num)->is_signed()){
+				switch(size){
+					case 1: visit_reflected_scalar<std::int8_t>(p, fn); break;
+					case 2: visit_reflected_scalar<std::int16_t>(p, fn); break;
+					case 4: visit_reflected_scalar<std::int32_t>(p, fn); break;
+					default: visit_reflected_scalar<std::int64_t>(p, fn); break;
+				}
+			}
+			else{
+				switch(size){
+					case 1: visit_reflected_scalar<std::uint8_t>(p, fn); break;
+					case 2: visit_reflected_scalar<std::uint16_t>(p, fn); break;
+					case 4: visit_reflected_scalar<std::uint32_t>(p, fn); break;
+					default: visit_reflected_scalar<std::uint64_t>(p, fn); break;
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Format a value only known through its runtime type, in the compact layout of `fmt::formatter`.
+		 */
+		inline void format_reflected(fmt::memory_buffer &out, refl::type_info type, const void *p, unsigned depth){
+			if(!type || depth > 32){
+				out.append(std::string_view("<?>"));
+			}
+			else if(auto cls = dynamic_cast<refl::class_info>(type)){
+				format_reflected_class(out, cls, p, depth);
+			}
+			else if(auto info = dynamic_cast<refl::enum_info>(type)){
+				format_reflected_enum(out, info, p);
+			}
+			else if(auto num = dynamic_cast<refl::num_info>(type)){
+				const auto formatted = visit_reflected_num(num, p, [&](auto val){
+					fmt::format_to(std::back_inserter(out), "{}", val);
+				});
+
+				if(!formatted) out.append(type->name());
+			}
+			else{
+				out.push_back('<');
+				out.append(type->name());
+				out.push_back('>');
+			}
+		}
+	}
+
+	/**
+	 * @brief Formats records written by `logger`, looking argument types up in the reflection registry.
+	 *
+	 * Decoding only needs the registry, so it can run on any thread. Records hold the address of their
+	 * format string rather than a copy, so they can only be decoded by the process that wrote them.
+	 */
+	class log_decoder{
+		public:
+			/**
+			 * @brief Format a record consumed from a `log_ring`.
+			 */
+			std::string format(const void *record, std::size_t size){
+				const auto bytes = static_cast<const unsigned char*>(record);
+
+				detail::log_record_header header;
+				if(size < sizeof(header)) return "<truncated log record>";
+				std::memcpy(&header, bytes, sizeof(header));
+
+				const std::string_view format_str(header.format, header.format_size);
+
+				fmt::dynamic_format_arg_store<fmt::format_context> args;
+				args.reserve(header.num_args, 0);
+
+				std::size_t offset = sizeof(header);
+
+				for(std::uint32_t i = 0; i < header.num_args; i++){
+					detail::log_arg_header arg;
+					if(size - offset < sizeof(arg)) return "<truncated log record>";
+					std::memcpy(&arg, bytes + offset, sizeof(arg));
+					offset += sizeof(arg);
+
+					if(size - offset < arg.size) return "<truncated log record>";
+
+					const auto data = bytes + offset;
+					offset += arg.size;
+
+					if(arg.type_id == detail::log_string_id){
+						args.push_back(std::string(reinterpret_cast<const char*>(data), arg.size));
+						continue;
+					}
+					else if(arg.type_id == detail::log_bool_id && arg.size == 1){
+						args.push_back(*data != 0);
+						continue;
+					}
+
+					const auto type = type_by_id(arg.type_id);
+
+					// numbers keep their native type so format specs like `{:.2f}` and `{:x}` apply to them
+					if(auto num = dynamic_cast<refl::num_info>(type); num && num->size() == arg.size){
+						const auto pushed = detail::visit_reflected_num(num, data, [&](auto val){ args.push_back(val); });
+						if(pushed) continue;
+					}
+
+					// copied out of the ring so members can be read with their natural alignment
+					m_scratch.resize((arg.size / sizeof(std::max_align_t)) + 1);
+					std::memcpy(m_scratch.data(), data, arg.size);
+
+					m_buffer.clear();
+					detail::format_reflected(m_buffer, type, m_scratch.data());
+					args.push_back(fmt::to_string(m_buffer));
+				}
+
+				try{
+					return fmt::vformat(format_str, args);
+				}
+				catch(const fmt::format_error &err){
+					return fmt::format("{} <format error: {}>", format_str, err.what());
+				}
+			}
+
+		private:
+			refl::type_info type_by_id(std::uint64_t id){
+				auto res = m_types.find(id);
+				if(res != m_types.end()) return res->second;
+
+				const auto type = refl::reflect_by_id(id);
+				m_types.emplace(id, type);
+				return type;
+			}
+
+			std::unordered_map<std::uint64_t, refl::type_info> m_types;
+			std::vector<std::max_align_t> m_scratch;
+			fmt::memory_buffer m_buffer;
+	};
+
+	/**
+	 * @brief Logger that defers formatting, copying the raw bytes of arguments on the logging thread.
+	 *
+	 * Each logging thread writes to its own `log_ring`. Records are formatted later with fmt format
+	 * strings, either by a background thread or by calling `drain`. Arguments may be strings, arithmetic
+	 * values, reflected enums and trivially copyable reflected classes; anything else fails to compile.
+	 */
+	class logger{
+		public:
+			using sink_fn = std::function<void(std::string_view)>;
+
+			/**
+			 * @param sink called with every formatted line
+			 * @param ring_capacity bytes in each thread's ring
+			 * @param background whether to start a thread that drains the rings
+			 */
+			explicit logger(sink_fn sink, std::size_t ring_capacity = 1 << 16, bool background = true)
+				: m_id(next_id()), m_sink(std::move(sink)), m_ring_capacity(ring_capacity)
+			{
+				if(background){
+					m_thread = std::thread([this]{ run(); });
+				}
+			}
+
+			~logger(){
+				if(m_thread.joinable()){
+					{
+						std::lock_guard lock(m_wake_mut);
+						m_stop = true;
+					}
+
+					m_wake.notify_one();
+					m_thread.join();
+				}
+
+				drain();
+			}
+
+			logger(const logger&) = delete;
+			logger &operator=(const logger&) = delete;
+
+			/**
+			 * @brief Queue a record.
+			 * @param format fmt format string, only its address is stored so it must outlive the logger
+			 * @returns `false` if the calling thread's ring is full and the record was dropped
+			 */
+			template<std::size_t N, typename ... Args>
+			bool log(const char(&format)[N], const Args &... args){
+				static_assert(
+					(detail::is_loggable<Args> && ...),
+					"log arguments must be strings, arithmetic values, reflected enums or trivially copyable reflected classes"
+				);
+
+				const std::size_t size = sizeof(detail::log_record_header) + (std::size_t(0) + ... + detail::log_arg_size(args));
+
+				auto &&ring = local_ring();
+
+				auto out = static_cast<unsigned char*>(ring.reserve(size));
+				if(!out){
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+
+				const detail::log_record_header header{ format, static_cast<std::uint32_t>(N - 1), sizeof...(Args) };
+				std::memcpy(out, &header, sizeof(header));
+				out += sizeof(header);
+
+				((out = detail::write_log_arg(out, args)), ...);
+
+				ring.commit();
+
+				if(m_sleeping.load(std::memory_order_seq_cst)){
+					wake();
+				}
+
+				return true;
+			}
+
+			/**
+			 * @brief Format every queued record on the calling thread.
+			 * @returns number of records formatted
+			 */
+			std::size_t drain(){
+				std::lock_guard consumer_lock(m_consumer_mut);
+
+				std::vector<ring_entry> rings;
+				{
+					std::lock_guard lock(m_rings_mut);
+					rings = m_rings;
+				}
+
+				std::size_t ret = 0;
+				std::vector<const log_ring*> finished;
+
+				for(auto &&entry : rings){
+					// once the thread has exited nothing more is committed, so this drains the ring for good
+					const bool exited = entry.thread.expired();
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					ret += entry.ring->consume([this](const void *record, std::size_t size){
+						m_sink(m_decoder.format(record, size));
+					});
+
+					if(exited) finished.emplace_back(entry.ring.get());
+				}
+
+				if(!finished.empty()){
+					std::lock_guard lock(m_rings_mut);
+
+					const auto is_finished = [&](const ring_entry &entry){
+						return std::find(finished.begin(), finished.end(), entry.ring.get()) != finished.end();
+					};
+
+					m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), is_finished), m_rings.end());
+				}
+
+				return ret;
+			}
+
+			/**
+			 * @brief Get the number of thread rings held, including those of exited threads not yet drained.
+			 */
+			std::size_t num_rings(){
+				std::lock_guard lock(m_rings_mut);
+				return m_rings.size();
+			}
+
+			/**
+			 * @brief Get the number of records dropped because a ring was full.
+			 */
+			std::size_t dropped() const noexcept{ return m_dropped.load(std::memory_order_relaxed); }
+
+		private:
+			struct ring_entry{
+				std::shared_ptr<log_ring> ring;
+				std::weak_ptr<const void> thread;
+			};
+
+			static std::uint64_t next_id() noexcept{
+				static std::atomic<std::uint64_t> counter = 0;
+				return ++counter;
+			}
+
+			log_ring &local_ring(){
+				struct cache_entry{
+					std::uint64_t owner = 0;
+					log_ring *ring = nullptr;
+				};
+
+				thread_local cache_entry last;
+				if(last.owner == m_id) return *last.ring;
+
+				// `alive` expires when the thread exits, which lets `drain` drop the thread's rings
+				struct thread_rings{
+					std::shared_ptr<const void> alive = std::make_shared<char>();
+					std::unordered_map<std::uint64_t, std::weak_ptr<log_ring>> rings;
+				};
+
+				thread_local thread_rings local;
+
+				auto &&entry = local.rings[m_id];
+				auto ring = entry.lock();
+
+				if(!ring){
+					for(auto it = local.rings.begin(); it != local.rings.end();){
+						if(it->second.expired() && it->first != m_id) it = local.rings.erase(it);
+						else ++it;
+					}
+
+					ring = std::make_shared<log_ring>(m_ring_capacity);
+					entry = ring;
+
+					std::lock_guard lock(m_rings_mut);
+					m_rings.push_back({ ring, local.alive });
+				}
+
+				last = { m_id, ring.get() };
+				return *ring;
+			}
+
+			void wake(){
+				{
+					std::lock_guard lock(m_wake_mut);
+					m_sleeping.store(false, std::memory_order_relaxed);
+				}
+
+				m_wake.notify_one();
+			}
+
+			void run(){
+				std::unique_lock lock(m_wake_mut);
+
+				while(!m_stop){
+					lock.unlock();
+					auto n = drain();
+
+					if(n == 0){
+						// drained again after raising the flag, records committed before a producer saw it are not missed
+						m_sleeping.store(true, std::memory_order_seq_cst);
+						n = drain();
+					}
+
+					lock.lock();
+
+					if(n == 0){
+						// the timeout only covers a producer that read the flag before it was raised
+						m_wake.wait_for(lock, std::chrono::milliseconds(100), [this]{
+							return m_stop || !m_sleeping.load(std::memory_order_relaxed);
+						});
+					}
+
+					m_sleeping.store(false, std::memory_order_relaxed);
+				}
+			}
+
+			std::uint64_t m_id;
+			sink_fn m_sink;
+			std::size_t m_ring_capacity;
+
+			std::mutex m_rings_mut;
+			std::vector<ring_entry> m_rings;
+
+			std::mutex m_consumer_mut;
+			log_decoder m_decoder;
+
+			std::atomic<std::size_t> m_dropped = 0;
+
+			std::mutex m_wake_mut;
+			std::condition_variable m_wake;
+			std::atomic<bool> m_sleeping = false;
+			bool m_stop = false;
+			std::thread m_thread;
+	};
+}
+
+#ifndef METACPP_NO_NAMESPACE_ALIAS
+namespace METACPP_SERIAL_NAMESPACE = serialpp;
+#endif
+
+/**
+ * @}
+ */
+
+#endif // !METACPP_LOG_HPP
@@ -10,6 +10,10 @@
 #ifndef METACPP_META_HPP
 #define METACPP_META_HPP 1
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <stdexcept>
 #include <variant>
 #include <string_view>
@@ -785,7 +789,27 @@ namespace metapp{
 	 * @brief Get the pretty name of a type.
 	 */
 	template<typename T>
-	inline constexpr std::string_view type_name = detail::get_type_name<T>();
+	REFLCPP_HIDDEN_SYMBOL inline constexpr std::string_view type_name = detail::get_type_name<T>();
+
+	namespace detail{
+		constexpr std::uint64_t hash_name(std::string_view str) noexcept{
+			// 64-bit FNV-1a
+			std::uint64_t ret = 0xcbf29ce484222325ull;
+
+			for(char c : str){
+				ret ^= static_cast<unsigned char>(c);
+				ret *= 0x100000001b3ull;
+			}
+
+			return ret;
+		}
+	}
+
+	/**
+	 * @brief Get a stable 64-bit identifier for a type, hashed from its pretty name.
+	 */
+	template<typename T>
+	inline constexpr std::uint64_t type_id = detail::hash_name(type_name<T>);
 
 	namespace detail{
 		template<typename Ent, std::size_t Idx>
@@ -945,6 +969,8 @@ namespace metapp{
 		static constexpr std::string_view name = detail::class_method_info_data<Class, get_v<Idx>>::name;
 		static constexpr bool is_virtual = detail::class_method_info_data<Class, get_v<Idx>>::is_virtual;
 		static constexpr auto ptr = detail::class_method_info_data<Class, get_v<Idx>>::ptr;
+		static constexpr bool is_accessable = !is_instantiation<std::decay_t<decltype(ptr)>, inaccessible>;
+		static constexpr bool is_static = !std::is_member_function_pointer_v<ptr_type>;
 
 		template<typename T, typename ... Args>
 		static constexpr decltype(auto) call(T &&cls, Args &&... args){
@@ -952,6 +978,31 @@ namespace metapp{
 		}
 	};
 
+	namespace detail{
+		inline constexpr std::size_t unknown_offset = std::size_t(-1);
+
+		// offsetof is only reliable for standard layout classes, `fn` is never instantiated for others
+		template<typename Class, typename Fn>
+		constexpr std::size_t member_offset(Fn &&fn) noexcept{
+			if constexpr(std::is_standard_layout_v<Class>){
+				return fn(static_cast<Class*>(nullptr));
+			}
+			else{
+				return unknown_offset;
+			}
+		}
+
+		template<typename Data, typename = void>
+		struct member_offset_helper{
+			static constexpr std::size_t value = unknown_offset;
+		};
+
+		template<typename Data>
+		struct member_offset_helper<Data, std::void_t<decltype(Data::offset)>>{
+			static constexpr std::size_t value = Data::offset;
+		};
+	}
+
 	/**
 	 * @brief Information about a class member.
 	 */
@@ -965,6 +1016,12 @@ namespace metapp{
 		static constexpr std::size_t index = Idx{};
 		static constexpr std::string_view name = detail::class_member_info_data<Class, get_v<Idx>>::name;
 		static constexpr auto ptr = detail::class_member_info_data<Class, get_v<Idx>>::ptr;
+		static constexpr bool is_accessable = !is_instantiation<std::decay_t<decltype(ptr)>, inaccessible>;
+
+		/**
+		 * @brief Byte offset of the member, `detail::unknown_offset` if it is inaccessible or the class isn't standard layout.
+		 */
+		static constexpr std::size_t offset = detail::member_offset_helper<detail::class_member_info_data<Class, get_v<Idx>>>::value;
 
 		template<typename T>
 		static constexpr decltype(auto) get(T &&cls){
@@ -1053,6 +1110,11 @@ namespace metapp{
 	}
 #endif
 
+	namespace detail{
+		template<typename T, typename = void>
+		struct layout_fingerprint_helper;
+	}
+
 	/**
 	 * @brief Information about a class.
 	 */
@@ -1068,6 +1130,12 @@ namespace metapp{
 
 		static constexpr bool is_abstract = std::is_abstract_v<Class>;
 
+		/**
+		 * @brief Hash of the size, alignment, members and bases of the class.
+		 * Equal fingerprints mean two builds agree on the layout of the class.
+		 */
+		static constexpr std::uint64_t layout_fingerprint = detail::layout_fingerprint_helper<Class>::value;
+
 #if __cplusplus >= 202002L && !METACPP_TOOL_RUN
 		template<fixed_str Scope, fixed_str Name>
 		using query_attributes = typename detail::query_attribs_helper<Scope, Name, attributes>::type;
@@ -1163,6 +1231,48 @@ namespace metapp{
 	template<typename Class>
 	using members = typename class_info<Class>::members;
 
+	namespace detail{
+		template<typename Ts>
+		struct non_empty_types;
+
+		template<>
+		struct non_empty_types<types<>>{
+			using type = types<>;
+		};
+
+		template<typename T, typename ... Ts>
+		struct non_empty_types<types<T, Ts...>>{
+			using rest = typename non_empty_types<types<Ts...>>::type;
+			using type = std::conditional_t<std::is_empty_v<T>, rest, join<types<T>, rest>>;
+		};
+
+		template<typename Bases>
+		struct data_bases_helper;
+
+		template<>
+		struct data_bases_helper<types<>>{
+			using type = types<>;
+		};
+
+		template<typename Base, typename ... Bases>
+		struct data_bases_helper<types<Base, Bases...>>{
+			using base_types = std::conditional_t<Base::is_variadic, typename Base::type, types<typename Base::type>>;
+			using rest = typename data_bases_helper<types<Bases...>>::type;
+
+			using type = std::conditional_t<
+				Base::access == access_kind::public_,
+				join<typename non_empty_types<base_types>::type, rest>,
+				rest
+			>;
+		};
+	}
+
+	/**
+	 * @brief Get the public bases of a class that hold data, with variadic bases expanded.
+	 */
+	template<typename Class>
+	using data_bases = typename detail::data_bases_helper<bases<Class>>::type;
+
 	/**
 	 * @brief Information about an enumeration value.
 	 */
@@ -1210,30 +1320,119 @@ namespace metapp{
 			}
 		};
 
-		template<typename Enum, typename Values>
-		struct get_value_name_helper;
+		/**
+		 * @brief Lookup table from enum values to names.
+		 *
+		 * Enums whose values span a small range are looked up with a single index into a table of names,
+		 * others with a binary search over the sorted values. The first name of aliased values is used.
+		 */
+		template<typename Enum, typename Values = enum_values<Enum>>
+		struct enum_name_table;
 
-		template<typename Enum>
-		struct get_value_name_helper<Enum, types<>>{
-			static constexpr std::string_view get(Enum val){
-				throw std::logic_error("enum does not contain the value passed");
-				return "";
+		template<typename Enum, typename ... Values>
+		struct enum_name_table<Enum, types<Values...>>{
+			using underlying = std::underlying_type_t<Enum>;
+			using wide = std::conditional_t<std::is_signed_v<underlying>, std::int64_t, std::uint64_t>;
+
+			static constexpr std::size_t count = sizeof...(Values);
+
+			static constexpr wide values[] = { static_cast<wide>(static_cast<underlying>(Values::value))..., 0 };
+			static constexpr std::string_view names[] = { Values::name..., {} };
+
+			static constexpr wide min_value() noexcept{
+				wide ret = values[0];
+				for(std::size_t i = 1; i < count; i++) ret = values[i] < ret ? values[i] : ret;
+				return ret;
 			}
-		};
 
-		template<typename Enum, typename Value, typename ... Values>
-		struct get_value_name_helper<Enum, types<Value, Values...>>{
-			static constexpr std::string_view get(Enum val){
-				if(static_cast<Enum>(Value::value) == val){
-					return Value::name;
+			static constexpr wide max_value() noexcept{
+				wide ret = values[0];
+				for(std::size_t i = 1; i < count; i++) ret = values[i] > ret ? values[i] : ret;
+				return ret;
+			}
+
+			static constexpr wide min = min_value();
+			static constexpr std::uint64_t span = static_cast<std::uint64_t>(max_value()) - static_cast<std::uint64_t>(min);
+
+			static constexpr bool is_dense = count > 0 && span < (count * 2) + 8;
+
+			// index into `names` for every value in the range, `count` (an empty name) for gaps
+			struct dense_t{
+				std::size_t indices[is_dense ? span + 1 : 1];
+			};
+
+			static constexpr dense_t make_dense() noexcept{
+				dense_t ret{};
+
+				for(auto &&idx : ret.indices) idx = count;
+
+				if constexpr(is_dense){
+					for(std::size_t i = count; i-- > 0;){
+						ret.indices[static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(min)] = i;
+					}
+				}
+
+				return ret;
+			}
+
+			struct sorted_t{
+				wide values[count + 1];
+				std::size_t indices[count + 1];
+			};
+
+			// stable insertion sort keeps the first of aliased values in front
+			static constexpr sorted_t make_sorted() noexcept{
+				sorted_t ret{};
+
+				for(std::size_t i = 0; i < count; i++){
+					std::size_t j = i;
+
+					for(; j > 0 && ret.values[j - 1] > values[i]; j--){
+						ret.values[j] = ret.values[j - 1];
+						ret.indices[j] = ret.indices[j - 1];
+					}
+
+					ret.values[j] = values[i];
+					ret.indices[j] = i;
+				}
+
+				return ret;
+			}
+
+			static constexpr dense_t dense = make_dense();
+			static constexpr sorted_t sorted = make_sorted();
+
+			static constexpr std::string_view find(Enum val) noexcept{
+				const auto v = static_cast<wide>(static_cast<underlying>(val));
+
+				if constexpr(is_dense){
+					const auto idx = static_cast<std::uint64_t>(v) - static_cast<std::uint64_t>(min);
+					return names[idx <= span ? dense.indices[idx] : count];
 				}
 				else{
-					return get_value_name_helper<Enum, types<Values...>>::get(val);
+					std::size_t lo = 0, hi = count;
+
+					while(lo < hi){
+						const auto mid = lo + ((hi - lo) / 2);
+						if(sorted.values[mid] < v) lo = mid + 1;
+						else hi = mid;
+					}
+
+					return names[lo < count && sorted.values[lo] == v ? sorted.indices[lo] : count];
 				}
 			}
 		};
 	}
 
+	/**
+	 * @brief Get the name of an enum value, or an empty string if no enumerator has the value.
+	 * @param value Value to get the name of
+	 */
+	template<typename Enum>
+	inline constexpr std::string_view find_value_name(Enum value) noexcept{
+		return detail::enum_name_table<Enum>::find(value);
+	}
+
 	/**
 	 * @brief Get an enum value by name.
 	 * @param name Name of the value to retrieve
@@ -1250,8 +1449,12 @@ namespace metapp{
 	 */
 	template<typename Enum>
 	inline constexpr std::string_view get_value_name(Enum value){
-		using info = enum_info<Enum>;
-		return detail::get_value_name_helper<Enum, typename info::values>::get(value);
+		const auto name = find_value_name(value);
+		if(name.empty()){
+			throw std::logic_error("enum does not contain the value passed");
+		}
+
+		return name;
 	}
 
 	/**
@@ -1311,6 +1514,348 @@ namespace metapp{
 	template<typename Ent>
 	inline constexpr bool has_info = detail::has_info_helper<Ent>::value;
 
+	namespace detail{
+		template<typename Enum, typename = void>
+		struct has_enum_info_helper: std::false_type{};
+
+		template<typename Enum>
+		struct has_enum_info_helper<Enum, std::void_t<decltype(enum_info_data<Enum>::name)>>: std::true_type{};
+	}
+
+	/**
+	 * @brief Check if introspection information exists for an enum.
+	 */
+	template<typename Enum>
+	inline constexpr bool has_enum_info = detail::has_enum_info_helper<Enum>::value;
+
+	namespace detail{
+		constexpr std::uint64_t mix_hash(std::uint64_t hash, std::uint64_t value) noexcept{
+			return (hash ^ value) * 0x100000001b3ull;
+		}
+
+		// types without metadata only contribute their identity, size and alignment
+		template<typename T, typename>
+		struct layout_fingerprint_helper{
+			static constexpr std::uint64_t value = mix_hash(mix_hash(type_id<T>, sizeof(T)), alignof(T));
+		};
+
+		template<typename Ts>
+		struct layout_fingerprint_list;
+
+		template<typename ... Ts>
+		struct layout_fingerprint_list<types<Ts...>>{
+			static constexpr std::uint64_t mix(std::uint64_t hash) noexcept{
+				((hash = mix_hash(hash, layout_fingerprint_helper<Ts>::value)), ...);
+				return hash;
+			}
+		};
+
+		template<typename Members>
+		struct layout_fingerprint_members;
+
+		template<typename ... Members>
+		struct layout_fingerprint_members<types<Members...>>{
+			static constexpr std::uint64_t mix(std::uint64_t hash) noexcept{
+				((hash = mix_hash(mix_hash(mix_hash(hash, hash_name(Members::name)), Members::offset), layout_fingerprint_helper<typename Members::type>::value)), ...);
+				return hash;
+			}
+		};
+
+		template<typename Bases>
+		struct layout_fingerprint_bases;
+
+		template<typename ... Bases>
+		struct layout_fingerprint_bases<types<Bases...>>{
+			template<typename Base>
+			static constexpr std::uint64_t mix_base(std::uint64_t hash) noexcept{
+				if constexpr(Base::is_variadic){
+					return layout_fingerprint_list<typename Base::type>::mix(hash);
+				}
+				else{
+					return mix_hash(hash, layout_fingerprint_helper<typename Base::type>::value);
+				}
+			}
+
+			static constexpr std::uint64_t mix(std::uint64_t hash) noexcept{
+				((hash = mix_base<Bases>(hash)), ...);
+				return hash;
+			}
+		};
+
+		template<typename Class>
+		struct layout_fingerprint_helper<Class, std::enable_if_t<has_info<Class>>>{
+			static constexpr std::uint64_t value = layout_fingerprint_members<typename class_info<Class>::members>::mix(
+				layout_fingerprint_bases<typename class_info<Class>::bases>::mix(
+					mix_hash(mix_hash(type_id<Class>, sizeof(Class)), alignof(Class))
+				)
+			);
+		};
+	}
+
+	/**
+	 * @brief Get a 64-bit fingerprint of the layout of a type.
+	 * @see class_info::layout_fingerprint
+	 */
+	template<typename T>
+	inline constexpr std::uint64_t layout_fingerprint = detail::layout_fingerprint_helper<T>::value;
+
+	namespace detail{
+		inline std::uint64_t load_u64(const unsigned char *p) noexcept{
+			std::uint64_t ret;
+			std::memcpy(&ret, p, sizeof(ret));
+			return ret;
+		}
+
+		constexpr std::uint64_t rotl64(std::uint64_t x, unsigned n) noexcept{
+			return (x << n) | (x >> (64 - n));
+		}
+
+		constexpr std::uint64_t fmix64(std::uint64_t x) noexcept{
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			return x ^ (x >> 31);
+		}
+
+		/**
+		 * @brief Hash a block of bytes, 16 bytes per step with two independent lanes.
+		 */
+		inline std::uint64_t hash_bytes(const void *data, std::size_t n, std::uint64_t seed = 0) noexcept{
+			constexpr std::uint64_t k0 = 0x9e3779b97f4a7c15ull, k1 = 0xc2b2ae3d27d4eb4full, k2 = 0x165667b19e3779f9ull;
+
+			auto p = static_cast<const unsigned char*>(data);
+
+			std::uint64_t h0 = seed ^ k0;
+			std::uint64_t h1 = (seed + n) ^ k1;
+
+			for(; n >= 16; n -= 16, p += 16){
+				h0 = rotl64(h0 ^ (load_u64(p) * k1), 31) * k0;
+				h1 = rotl64(h1 ^ (load_u64(p + 8) * k2), 29) * k0;
+			}
+
+			if(n >= 8){
+				h0 = rotl64(h0 ^ (load_u64(p) * k1), 31) * k0;
+				p += 8;
+				n -= 8;
+			}
+
+			if(n > 0){
+				std::uint64_t tail = 0;
+				std::memcpy(&tail, p, n);
+				h1 = rotl64(h1 ^ (tail * k2), 29) * k0;
+			}
+
+			return fmix64(h0 ^ rotl64(h1, 17));
+		}
+
+		constexpr std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value) noexcept{
+			return fmix64(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4)));
+		}
+
+		template<typename T, typename = void>
+		struct has_std_hash: std::false_type{};
+
+		// disabled `std::hash` specializations aren't default constructible
+		template<typename T>
+		struct has_std_hash<T, std::enable_if_t<std::is_default_constructible_v<std::hash<T>>>>: std::true_type{};
+
+		template<typename T, typename = void>
+		struct is_hash_range: std::false_type{};
+
+		template<typename T>
+		struct is_hash_range<T, std::void_t<decltype(std::begin(std::declval<const T&>()), std::end(std::declval<const T&>()))>>: std::true_type{};
+
+		template<typename T, typename = void>
+		struct is_contiguous_hash_range: std::false_type{};
+
+		template<typename T>
+		struct is_contiguous_hash_range<T, std::void_t<decltype(std::data(std::declval<const T&>()), std::size(std::declval<const T&>()))>>:
+			std::bool_constant<std::has_unique_object_representations_v<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<const T&>()))>>>>{};
+
+		// `Checking` holds the classes whose check is in progress, a class containing itself assumes it is hashable
+		template<typename T, typename Checking = types<>>
+		struct is_hashable_helper;
+
+		template<typename Members, typename Checking>
+		struct members_hashable;
+
+		template<typename ... Members, typename Checking>
+		struct members_hashable<types<Members...>, Checking>:
+			std::conjunction<std::disjunction<std::bool_constant<!Members::is_accessable>, is_hashable_helper<std::remove_cv_t<typename Members::type>, Checking>>...>{};
+
+		template<typename Bases, typename Checking>
+		struct bases_hashable;
+
+		template<typename ... Bases, typename Checking>
+		struct bases_hashable<types<Bases...>, Checking>: std::conjunction<is_hashable_helper<Bases, Checking>...>{};
+
+		template<typename T, typename Checking>
+		struct is_hashable_helper{
+			static constexpr bool value = [](){
+				if constexpr(std::has_unique_object_representations_v<T> || std::is_floating_point_v<T>){
+					return true;
+				}
+				else if constexpr(has_info<T>){
+					if constexpr(Checking::template contains<T>){
+						return true;
+					}
+					else{
+						using checking = join<types<T>, Checking>;
+						return bases_hashable<data_bases<T>, checking>::value && members_hashable<typename class_info<T>::members, checking>::value;
+					}
+				}
+				else if constexpr(has_std_hash<T>::value){
+					return true;
+				}
+				else if constexpr(is_hash_range<T>::value){
+					return is_hashable_helper<std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(std::declval<const T&>()))>>, Checking>::value;
+				}
+				else{
+					return false;
+				}
+			}();
+		};
+
+		template<typename T>
+		std::uint64_t hash_value(const T &val, std::uint64_t seed);
+
+		template<typename Member>
+		constexpr bool is_hash_raw_member() noexcept{
+			return Member::is_accessable && Member::offset != unknown_offset && std::has_unique_object_representations_v<typename Member::type>;
+		}
+
+		/**
+		 * @brief Members of a class grouped into runs of padding-free members with unique object representations,
+		 * each hashed as one block of bytes. Public bases holding data are hashed first.
+		 */
+		template<typename Class, typename Members = typename class_info<Class>::members>
+		struct hash_layout;
+
+		template<typename Class, typename ... Members>
+		struct hash_layout<Class, types<Members...>>{
+			static constexpr std::size_t num_members = sizeof...(Members);
+
+			static constexpr bool raw[] = { is_hash_raw_member<Members>()..., false };
+			static constexpr std::size_t offsets[] = { Members::offset..., 0 };
+			static constexpr std::size_t sizes[] = { sizeof(typename Members::type)..., 0 };
+
+			struct runs_t{
+				// bytes in the run starting at each member, `0` if no run starts there
+				std::size_t bytes[num_members + 1];
+				// whether a member is hashed by an earlier member's run
+				bool covered[num_members + 1];
+			};
+
+			static constexpr runs_t make_runs() noexcept{
+				runs_t ret{};
+				std::size_t start = 0;
+
+				for(std::size_t i = 0; i < num_members; i++){
+					if(!raw[i]) continue;
+
+					if(i > 0 && raw[i - 1] && offsets[i - 1] + sizes[i - 1] == offsets[i]){
+						ret.covered[i] = true;
+						ret.bytes[start] += sizes[i];
+					}
+					else{
+						start = i;
+						ret.bytes[i] = sizes[i];
+					}
+				}
+
+				return ret;
+			}
+
+			static constexpr runs_t runs = make_runs();
+
+			template<std::size_t I>
+			static std::uint64_t hash_member(const Class &cls, std::uint64_t seed){
+				using member = get_t<types<Members...>, I>;
+
+				if constexpr(!member::is_accessable || runs.covered[I]){
+					return seed;
+				}
+				else if constexpr(runs.bytes[I] != 0){
+					return hash_bytes(reinterpret_cast<const unsigned char*>(std::addressof(cls)) + offsets[I], runs.bytes[I], seed);
+				}
+				else{
+					return hash_value(member::get(cls), seed);
+				}
+			}
+
+			template<std::size_t ... Is>
+			static std::uint64_t hash(const Class &cls, std::uint64_t seed, std::index_sequence<Is...>){
+				((seed = hash_member<Is>(cls, seed)), ...);
+				return seed;
+			}
+
+			template<typename ... Bases>
+			static std::uint64_t hash_bases(const Class &cls, std::uint64_t seed, types<Bases...>){
+				((seed = hash_value(static_cast<const Bases&>(cls), seed)), ...);
+				return seed;
+			}
+
+			static std::uint64_t hash(const Class &cls, std::uint64_t seed){
+				seed = hash_bases(cls, seed, data_bases<Class>{});
+				return hash(cls, seed, std::make_index_sequence<num_members>());
+			}
+		};
+
+		template<typename T>
+		std::uint64_t hash_value(const T &val, std::uint64_t seed){
+			if constexpr(std::has_unique_object_representations_v<T>){
+				return hash_bytes(std::addressof(val), sizeof(T), seed);
+			}
+			else if constexpr(std::is_floating_point_v<T>){
+				// equal values must hash equally, so `-0.0` is hashed as `0.0`
+				return hash_combine(seed, val == T(0) ? 0 : std::hash<T>{}(val));
+			}
+			else if constexpr(has_info<T>){
+				return hash_layout<T>::hash(val, seed);
+			}
+			else if constexpr(has_std_hash<T>::value){
+				return hash_combine(seed, std::hash<T>{}(val));
+			}
+			else if constexpr(is_contiguous_hash_range<T>::value){
+				const auto n = std::size(val);
+				return hash_bytes(std::data(val), n * sizeof(*std::data(val)), hash_combine(seed, n));
+			}
+			else{
+				std::uint64_t n = 0;
+
+				for(auto &&elem : val){
+					seed = hash_value(elem, seed);
+					++n;
+				}
+
+				return hash_combine(seed, n);
+			}
+		}
+	}
+
+	/**
+	 * @brief Check if `hash` can hash a type.
+	 */
+	template<typename T>
+	inline constexpr bool is_hashable = detail::is_hashable_helper<std::remove_cv_t<T>>::value;
+
+	/**
+	 * @brief Hash function object for reflected classes.
+	 *
+	 * Member hashes are combined in declaration order. Runs of adjacent members with unique object
+	 * representations and no padding between them are hashed as a single block of bytes. Other members
+	 * use `hash` recursively, `std::hash` or, for ranges, the hashes of their elements.
+	 *
+	 * @see METACPP_STD_HASH to use it as `std::hash`
+	 */
+	template<typename T>
+	struct hash{
+		static_assert(is_hashable<T>, "type or one of its members can not be hashed");
+
+		std::size_t operator()(const T &val) const noexcept(noexcept(detail::hash_value(val, 0))){
+			return static_cast<std::size_t>(detail::hash_value(val, 0));
+		}
+	};
+
 	/**
 	 * @brief Get information about the attributes of an entity.
 	 */
@@ -1369,6 +1914,13 @@ namespace metapp{
 	 */
 }
 
+/**
+ * @brief Specialize `std::hash` for a reflected type using `metapp::hash`.
+ * @note Must be used at global scope.
+ */
+#define METACPP_STD_HASH(...) \
+	template<> struct std::hash<__VA_ARGS__>: metapp::hash<__VA_ARGS__>{}
+
 #ifndef METACPP_NO_NAMESPACE_ALIAS
 namespace METACPP_META_NAMESPACE = metapp;
 #endif
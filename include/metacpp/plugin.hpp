@@ -17,8 +17,12 @@
 
 #include "refl.hpp"
 
-#include <vector>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 namespace pluginpp{
 	struct function_info{
@@ -44,21 +48,125 @@ namespace pluginpp{
 			virtual void *get_symbol(const std::string &name) const noexcept = 0;
 	};
 
+	/**
+	 * @brief A type listed in a plugin manifest.
+	 */
+	struct manifest_type{
+		std::string_view name;
+		std::uint64_t id;
+		std::uint64_t layout_fingerprint;
+		std::size_t size, alignment;
+		bool is_enum;
+		std::size_t num_attributes;
+		std::string_view attributes;
+
+		/**
+		 * @brief Get the arguments of an attribute.
+		 * @returns `std::nullopt` if the type doesn't have the attribute
+		 */
+		std::optional<std::vector<std::string_view>> attribute(std::string_view name) const;
+	};
+
+	/**
+	 * @brief Type manifest of a plugin, read without loading the plugin.
+	 * Strings point into the mapped file, which stays mapped for the life of the manifest.
+	 */
+	class manifest{
+		public:
+			manifest(std::shared_ptr<const void> data, std::vector<manifest_type> types) noexcept
+				: m_data(std::move(data)), m_types(std::move(types)){}
+
+			const std::vector<manifest_type> &types() const noexcept{ return m_types; }
+
+			const manifest_type *find(std::string_view name) const noexcept;
+			const manifest_type *find(std::uint64_t id) const noexcept;
+
+		private:
+			std::shared_ptr<const void> m_data;
+			std::vector<manifest_type> m_types;
+	};
+
+	/**
+	 * @brief Extension of the manifest file `add_plugin` places next to each reflected plugin.
+	 */
+	inline constexpr std::string_view manifest_extension = ".reflmanifest";
+
+	/**
+	 * @brief Read the type manifest of a plugin without loading it.
+	 * Maps `<path>.reflmanifest` if it exists and isn't older than the plugin, otherwise the manifest section of the plugin itself.
+	 * @returns `std::nullopt` if no manifest could be found
+	 */
+	std::optional<manifest> inspect(const std::filesystem::path &path);
+
 	/**
 	 * @brief Get a list of plugins placed in the same folder as the executable.
 	 */
 	std::vector<std::filesystem::path> nearby_plugins();
 
+	/**
+	 * @brief How loading a plugin treats a type whose layout fingerprint differs from the type already registered.
+	 * @see metapp::class_info::layout_fingerprint
+	 */
+	enum class layout_check{
+		ignore, ///< load without comparing layouts
+		warn, ///< report the mismatch and load the plugin anyway
+		reject ///< fail to load the plugin
+	};
+
+	/**
+	 * @brief Set how plugin loads treat layout mismatches, `layout_check::reject` by default.
+	 */
+	void set_layout_check(layout_check check) noexcept;
+
 	/**
 	 * @brief Try to load a plugin.
 	 * @returns `nullptr` on error, handle to the loaded plugin on success
 	 */
 	const library *load(const std::filesystem::path &path);
 
+	/**
+	 * @brief Load a set of plugins, inspecting the files in parallel.
+	 *
+	 * Plugin files are prefaulted and their ELF headers read on up to `num_threads` worker threads
+	 * (`0` uses the hardware concurrency). The plugins are then opened and published to the registry
+	 * one at a time, with every plugin loaded after the plugins in `paths` it links against.
+	 *
+	 * @returns handles in the same order as `paths`, `nullptr` for every plugin that failed to load
+	 */
+	std::vector<const library*> load_all(const std::vector<std::filesystem::path> &paths, std::size_t num_threads = 0);
+
 	/**
 	 * @brief Get a reference to the running executable.
 	 */
 	const library *self();
+
+	/**
+	 * @brief Load a plugin again from disk, removing the entities it previously registered in one step.
+	 * The previous library stays mapped until every `reader_guard` that existed during the swap is destroyed.
+	 * @returns handle to the new library, `nullptr` on error (the previous library stays loaded)
+	 */
+	const library *reload(const std::filesystem::path &path);
+
+	/**
+	 * @brief Remove a plugin's entities from the registry and release it once no readers remain.
+	 * @returns `false` if `lib` is not a loaded plugin
+	 */
+	bool unload(const library *lib);
+
+	/**
+	 * @brief Marks the current thread as using entities from loaded plugins.
+	 *
+	 * Libraries removed by `unload` or `reload` are only closed once every guard created before
+	 * the removal has been destroyed. Guards may be nested.
+	 */
+	class reader_guard{
+		public:
+			reader_guard();
+			~reader_guard();
+
+			reader_guard(const reader_guard&) = delete;
+			reader_guard &operator=(const reader_guard&) = delete;
+	};
 }
 
 #ifndef METACPP_NO_NAMESPACE_ALIAS
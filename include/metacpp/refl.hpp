@@ -10,13 +10,27 @@
 #ifndef METACPP_REFL_HPP
 #define METACPP_REFL_HPP 1
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <climits>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <typeindex>
+#include <typeinfo>
 #include <utility>
 
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
 #include "meta.hpp"
 
 /**
@@ -44,11 +58,105 @@ namespace reflpp{
 			virtual std::size_t num_attributes() const noexcept{ return 0; }
 			virtual const attribute_info_helper *attribute(std::size_t idx) const noexcept{ return nullptr; }
 			virtual std::type_index type_index() const noexcept = 0;
+			virtual std::uint64_t id() const noexcept{ return metapp::detail::hash_name(name()); }
+
+			virtual bool is_trivially_copyable() const noexcept{ return false; }
+			virtual bool is_trivially_relocatable() const noexcept{ return is_trivially_copyable(); }
+			virtual bool is_nothrow_relocatable() const noexcept{ return is_trivially_relocatable(); }
+
+			/**
+			 * @brief Check if `hash` and `equal` are implemented for the type.
+			 */
+			virtual bool is_hashable() const noexcept{ return false; }
+
+			/**
+			 * @brief Hash a value, consistent with `metapp::hash`.
+			 * @returns the hash of the value or `0` if the type is not hashable
+			 */
+			virtual std::size_t hash(const void*) const noexcept{ return 0; }
+
+			/**
+			 * @brief Compare two values of the type with `operator==`.
+			 * @returns `false` if the values differ or the type can not be compared
+			 */
+			virtual bool equal(const void*, const void*) const{ return false; }
+
+			virtual void *copy_construct(void *p, const void *src) const{
+				if(!is_trivially_copyable()) return nullptr;
+				std::memcpy(p, src, size());
+				return p;
+			}
+
+			virtual void *move_construct(void *p, void *src) const{
+				return copy_construct(p, src);
+			}
+
+			/**
+			 * @brief Move a value to uninitialized storage and destroy the source.
+			 * @returns `dst` on success, `nullptr` if the type can not be moved
+			 */
+			virtual void *relocate(void *dst, void *src) const{
+				if(is_trivially_relocatable()){
+					std::memcpy(dst, src, size());
+					return dst;
+				}
+
+				if(!move_construct(dst, src)) return nullptr;
+
+				destroy(src);
+				return dst;
+			}
+
+			/**
+			 * @brief Value-initialize `n` packed values.
+			 * @returns `p` on success, `nullptr` if the type can not be default constructed
+			 */
+			virtual void *construct_n(void *p, std::size_t n) const{
+				if(!is_trivially_copyable()) return nullptr;
+				std::memset(p, 0, n * size());
+				return p;
+			}
+
+			virtual void destroy_n(void *p, std::size_t n) const noexcept{
+				if(is_trivially_copyable()) return;
+
+				const auto bytes = reinterpret_cast<unsigned char*>(p);
+				const auto stride = size();
+
+				for(std::size_t i = 0; i < n; i++){
+					destroy(bytes + (i * stride));
+				}
+			}
+
+			/**
+			 * @brief Relocate `n` packed values to non-overlapping uninitialized storage.
+			 * @returns `dst` on success, `nullptr` if the type can not be moved
+			 */
+			virtual void *relocate_n(void *dst, void *src, std::size_t n) const{
+				if(is_trivially_relocatable()){
+					std::memcpy(dst, src, n * size());
+					return dst;
+				}
+
+				const auto dst_bytes = reinterpret_cast<unsigned char*>(dst);
+				const auto src_bytes = reinterpret_cast<unsigned char*>(src);
+				const auto stride = size();
+
+				for(std::size_t i = 0; i < n; i++){
+					if(!relocate(dst_bytes + (i * stride), src_bytes + (i * stride))){
+						return nullptr;
+					}
+				}
+
+				return dst;
+			}
 		};
 
 		struct num_info_helper;
 		struct int_info_helper;
 		struct function_info_helper;
+
+		using function_address = void(*)();
 		struct fn_ptr_info_helper;
 		struct class_info_helper;
 		struct enum_info_helper;
@@ -60,6 +168,56 @@ namespace reflpp{
 
 		template<typename T, typename = void>
 		struct reflect_helper;
+
+		/**
+		 * @brief Count that changes whenever entities are removed from the registry.
+		 */
+		extern std::atomic<std::uint64_t> registry_generation_count;
+
+		/**
+		 * @brief Get a count that changes whenever entities are removed from the registry.
+		 */
+		inline std::uint64_t registry_generation() noexcept{
+			return registry_generation_count.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Caches a reflected type until entities are next removed from the registry,
+		 * so a cached type never outlives the library it came from.
+		 */
+		template<typename Info>
+		class reflect_cache{
+			public:
+				template<typename Fn>
+				Info get(Fn &&fn){
+					const auto generation = registry_generation();
+
+					// `m_generation` is cleared while `m_info` is written, like a sequence lock
+					if(m_generation.load(std::memory_order_acquire) == generation){
+						auto ret = m_info.load(std::memory_order_relaxed);
+						std::atomic_thread_fence(std::memory_order_acquire);
+
+						if(m_generation.load(std::memory_order_relaxed) == generation){
+							return ret;
+						}
+					}
+
+					auto ret = fn();
+
+					std::lock_guard lock(m_mut);
+					m_generation.store(0, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+					m_info.store(ret, std::memory_order_relaxed);
+					m_generation.store(generation, std::memory_order_release);
+
+					return ret;
+				}
+
+			private:
+				std::mutex m_mut;
+				std::atomic<Info> m_info = nullptr;
+				std::atomic<std::uint64_t> m_generation = 0;
+		};
 	};
 
 	/**
@@ -119,6 +277,20 @@ namespace reflpp{
 	 */
 	type_info reflect(std::string_view name);
 
+	/**
+	 * @brief Try to dynamically get information about a type from its `std::type_index`.
+	 * @param index type index to search for
+	 * @returns `nullptr` on error, handle to found type on success
+	 */
+	type_info reflect(std::type_index index);
+
+	/**
+	 * @brief Try to dynamically get information about a type from its id.
+	 * @param id type id to search for, e.g. `metapp::type_id<T>`
+	 * @returns `nullptr` on error, handle to found type on success
+	 */
+	type_info reflect_by_id(std::uint64_t id);
+
 	/**
 	 * @brief Get information about every reflected type in a program.
 	 * @warning this can be an expensive operation
@@ -157,13 +329,26 @@ namespace reflpp{
 	 */
 	inline enum_info enum_(std::string_view name){ return reflect_enum(name); }	
 
+	/**
+	 * @brief Try to dynamically get information about a function from it's address.
+	 * @returns `nullptr` on error, handle to found function on success
+	 */
+	function_info reflect_function(detail::function_address address);
+
+	/**
+	 * @brief Get every overload of a reflected function.
+	 * @param name fully qualified name of the function, e.g. `"ns::name"`
+	 * @returns information about all overloads, empty if none were found
+	 */
+	std::vector<function_info> reflect_function(std::string_view name);
+
 	/**
 	 * @brief Get information about a function from it's pointer.
-	 * @warning Currently unimplemented.
+	 * @returns `nullptr` if the function isn't reflected
 	 */
 	template<typename Ret, typename ... Args>
 	function_info reflect(Ret(*ptr)(Args...)){
-		return nullptr;
+		return reflect_function(reinterpret_cast<detail::function_address>(ptr));
 	}
 
 	/**
@@ -177,12 +362,13 @@ namespace reflpp{
 
 	/**
 	 * @brief Get dynamic type information for a known type.
+	 * @note The result is cached until a plugin is unloaded or reloaded.
 	 * @see reflect
 	 */
 	template<typename T>
-	auto reflect(){
-		static auto ret = detail::reflect_helper<T>::reflect();
-		return ret;
+	REFLCPP_HIDDEN_SYMBOL auto reflect(){
+		static detail::reflect_cache<decltype(detail::reflect_helper<T>::reflect())> cache;
+		return cache.get([]{ return detail::reflect_helper<T>::reflect(); });
 	}
 
 	/**
@@ -246,8 +432,7 @@ namespace reflpp{
 			class_info operator->() const noexcept{ return m_info; }
 
 			static class_info base_info(){
-				static const class_info ret = reflect<Base>();
-				return ret;
+				return reflect<Base>();
 			}
 
 		private:
@@ -263,8 +448,8 @@ namespace reflpp{
 
 	template<typename Base>
 	std::vector<derived_info<Base>> reflect_all_derived(){
-		static auto all_cls = reflect_all_classes();
-		static auto base = reflect<Base>();
+		auto all_cls = reflect_all_classes();
+		auto base = reflect<Base>();
 
 		std::vector<derived_info<Base>> ret;
 
@@ -302,7 +487,7 @@ namespace reflpp{
 		public:
 			using arg_types = metapp::types<Args...>;
 
-			template<typename ... UArgs>
+			template<typename ... UArgs, std::enable_if_t<sizeof...(UArgs) == sizeof...(Args), int> = 0>
 			explicit args_pack(UArgs &&... args)
 				: args_pack(std::make_index_sequence<sizeof...(UArgs)>(), std::forward<UArgs>(args)...)
 			{}
@@ -346,19 +531,153 @@ namespace reflpp{
 		return args_pack<typename detail::arg_type_helper<Args>::type...>(std::forward<Args>(args)...);
 	}
 
+	/**
+	 * @brief Whether values of type `T` may be moved to new storage with `std::memcpy`.
+	 * @note Specialize this for types that are trivially relocatable but not trivially copyable.
+	 */
+	template<typename T>
+	struct is_trivially_relocatable: std::bool_constant<std::is_trivially_copyable_v<T>>{};
+
+	template<typename T, typename Deleter>
+	struct is_trivially_relocatable<std::unique_ptr<T, Deleter>>: is_trivially_relocatable<Deleter>{};
+
+	template<typename T>
+	struct is_trivially_relocatable<std::shared_ptr<T>>: std::true_type{};
+
+	template<typename T>
+	inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	/**
+	 * @brief Check if `type_info_helper::hash` hashes values of a type with `metapp::hash`.
+	 * @note Specialize this as `std::false_type` to skip checking the members of a type when its reflection info is generated.
+	 */
+	template<typename T>
+	struct is_value_hashable: std::bool_constant<metapp::is_hashable<T>>{};
+
+	template<typename T>
+	inline constexpr bool is_value_hashable_v = is_value_hashable<T>::value;
+
 	namespace detail{
+		template<typename T, typename = void>
+		struct has_equal_op: std::false_type{};
+
+		template<typename T>
+		struct has_equal_op<T, std::void_t<decltype(bool(std::declval<const T&>() == std::declval<const T&>()))>>: std::true_type{};
+
+		// standard containers declare `operator==` whether or not their elements can be compared
+		template<typename T, typename = void>
+		struct is_equality_comparable: has_equal_op<T>{};
+
+		template<typename T>
+		struct is_equality_comparable<T, std::void_t<typename T::value_type>>:
+			std::conjunction<has_equal_op<T>, is_equality_comparable<std::remove_cv_t<typename T::value_type>>>{};
+
 		template<typename T, typename Helper>
 		struct info_helper_base: Helper{
+			using object_type = std::remove_cv_t<T>;
+
 			std::string_view name() const noexcept override{ return metapp::type_name<T>; }
 			std::size_t size() const noexcept override{ return sizeof(T); }
 			std::size_t alignment() const noexcept override{ return alignof(T); }
 			void destroy(void *p) const noexcept override{ std::destroy_at(reinterpret_cast<T*>(p)); }
 			std::type_index type_index() const noexcept override{ return typeid(T); }
+			std::uint64_t id() const noexcept override{ return metapp::type_id<T>; }
+
+			bool is_trivially_copyable() const noexcept override{ return std::is_trivially_copyable_v<object_type>; }
+			bool is_trivially_relocatable() const noexcept override{ return is_trivially_relocatable_v<object_type>; }
+
+			bool is_nothrow_relocatable() const noexcept override{
+				return is_trivially_relocatable_v<object_type> || std::is_nothrow_move_constructible_v<object_type>;
+			}
+
+			bool is_hashable() const noexcept override{
+				return is_value_hashable_v<object_type> && is_equality_comparable<object_type>::value;
+			}
+
+			std::size_t hash(const void *p) const noexcept override{
+				if constexpr(is_value_hashable_v<object_type>){
+					return metapp::hash<object_type>{}(*reinterpret_cast<const object_type*>(p));
+				}
+				else{
+					return 0;
+				}
+			}
+
+			bool equal(const void *lhs, const void *rhs) const override{
+				if constexpr(is_equality_comparable<object_type>::value){
+					return *reinterpret_cast<const object_type*>(lhs) == *reinterpret_cast<const object_type*>(rhs);
+				}
+				else{
+					return false;
+				}
+			}
+
+			void *copy_construct(void *p, const void *src) const override{
+				if constexpr(std::is_copy_constructible_v<object_type>){
+					return new(p) object_type(*reinterpret_cast<const object_type*>(src));
+				}
+				else{
+					return nullptr;
+				}
+			}
+
+			void *move_construct(void *p, void *src) const override{
+				if constexpr(std::is_move_constructible_v<object_type>){
+					return new(p) object_type(std::move(*reinterpret_cast<object_type*>(src)));
+				}
+				else{
+					return nullptr;
+				}
+			}
+
+			void *relocate(void *dst, void *src) const override{
+				return relocate_n(dst, src, 1);
+			}
+
+			void *construct_n(void *p, std::size_t n) const override{
+				if constexpr(std::is_trivially_default_constructible_v<object_type> && std::is_trivially_copyable_v<object_type>){
+					std::memset(p, 0, n * sizeof(object_type));
+					return p;
+				}
+				else if constexpr(std::is_default_constructible_v<object_type>){
+					std::uninitialized_value_construct_n(reinterpret_cast<object_type*>(p), n);
+					return p;
+				}
+				else{
+					return nullptr;
+				}
+			}
+
+			void destroy_n(void *p, std::size_t n) const noexcept override{
+				if constexpr(!std::is_trivially_destructible_v<object_type>){
+					std::destroy_n(reinterpret_cast<object_type*>(p), n);
+				}
+			}
+
+			void *relocate_n(void *dst, void *src, std::size_t n) const override{
+				if constexpr(is_trivially_relocatable_v<object_type>){
+					std::memcpy(dst, src, n * sizeof(object_type));
+					return dst;
+				}
+				else if constexpr(std::is_move_constructible_v<object_type>){
+					const auto dst_vals = reinterpret_cast<object_type*>(dst);
+					const auto src_vals = reinterpret_cast<object_type*>(src);
+
+					std::uninitialized_move_n(src_vals, n, dst_vals);
+					std::destroy_n(src_vals, n);
+					return dst;
+				}
+				else{
+					return nullptr;
+				}
+			}
 		};
 
 		struct ref_info_helper: type_info_helper{
 			virtual type_info refered() const noexcept = 0;
 
+			bool is_trivially_copyable() const noexcept override{ return true; }
+
 			void *construct(void *p, args_pack_base *args) const override{
 				if(args->size() != 0) return nullptr;
 				return p;
@@ -368,6 +687,8 @@ namespace reflpp{
 		struct ptr_info_helper: type_info_helper{
 			virtual type_info pointed() const noexcept = 0;
 
+			bool is_trivially_copyable() const noexcept override{ return true; }
+
 			void *construct(void *p, args_pack_base *args) const override{
 				if(args->size() != 0) return nullptr;
 				return p;
@@ -378,9 +699,12 @@ namespace reflpp{
 			virtual type_info result() const noexcept = 0;
 			virtual std::size_t num_parameters() const noexcept= 0;
 			virtual type_info parameter(std::size_t idx) const noexcept = 0;
+
+			bool is_trivially_copyable() const noexcept override{ return true; }
 		};
 
 		type_info void_info() noexcept;
+		int_info bool_info() noexcept;
 		int_info int_info(std::size_t bits, bool is_signed) noexcept;
 		num_info float_info(std::size_t bits) noexcept;
 
@@ -401,13 +725,13 @@ namespace reflpp{
 		};
 
 		template<typename T>
-		struct float_info_helper_impl: info_helper_base<float_info_helper_impl<T>, num_info_helper>{
+		struct float_info_helper_impl: info_helper_base<T, num_info_helper>{
 			bool is_floating_point() const noexcept override{ return true; }
 			bool is_integer() const noexcept override{ return false; }
 		};
 
 		template<typename T>
-		struct int_info_helper_impl: info_helper_base<int_info_helper_impl<T>, int_info_helper>{
+		struct int_info_helper_impl: info_helper_base<T, int_info_helper>{
 			bool is_signed() const noexcept override{ return std::is_signed_v<T>; }
 		};
 
@@ -417,6 +741,15 @@ namespace reflpp{
 			virtual std::size_t num_params() const noexcept = 0;
 			virtual std::string_view param_name(std::size_t idx) const noexcept = 0;
 			virtual type_info param_type(std::size_t idx) const noexcept = 0;
+			virtual function_address address() const noexcept = 0;
+
+			/**
+			 * @brief Call the function with type-erased arguments.
+			 * @param args array of pointers to each argument
+			 * @param result storage for the result, a pointer to the result for reference results or `nullptr` to discard it
+			 * @returns whether the function could be called
+			 */
+			virtual bool invoke(void *const *args, void *result) const = 0;
 		};
 
 		struct class_member_helper{
@@ -425,25 +758,87 @@ namespace reflpp{
 			virtual std::size_t num_attributes() const noexcept = 0;
 			virtual attribute_info attribute(std::size_t idx) const noexcept = 0;
 			virtual void *get(void *self) const noexcept = 0;
+			virtual bool is_standard_layout() const noexcept = 0;
+			virtual std::size_t offset() const noexcept = 0;
+
+			/**
+			 * @brief Copy this member out of `n` objects spaced `stride` bytes apart.
+			 * @param out uninitialized storage for `n` packed values of the member type
+			 * @returns whether the member could be copied
+			 */
+			virtual bool gather(const void *objs, std::size_t stride, std::size_t n, void *out) const = 0;
 		};
 
+		/**
+		 * @brief Copy `n` elements of `elem_size` bytes spaced `stride` bytes apart into a packed array.
+		 */
+		void strided_copy(const void *src, std::size_t stride, std::size_t n, void *dst, std::size_t elem_size) noexcept;
+
+		template<typename Cls, typename T>
+		std::size_t member_offset(T Cls::*ptr) noexcept{
+			union probe_t{
+				probe_t(){}
+				~probe_t(){}
+				Cls obj;
+			} probe;
+
+			const auto base = reinterpret_cast<const unsigned char*>(std::addressof(probe.obj));
+			const auto member = reinterpret_cast<const unsigned char*>(std::addressof(probe.obj.*ptr));
+			return static_cast<std::size_t>(member - base);
+		}
+
 		struct class_method_helper{
 			virtual std::string_view name() const noexcept = 0;
 			virtual type_info result_type() const noexcept = 0;
 			virtual std::size_t num_params() const noexcept = 0;
 			virtual std::string_view param_name(std::size_t idx) const noexcept = 0;
 			virtual type_info param_type(std::size_t idx) const noexcept = 0;
+			virtual bool is_static() const noexcept = 0;
+			virtual bool invoke(void *self, void *const *args, void *result) const = 0;
 		};
 
+		template<typename T>
+		inline T &&forward_arg(void *arg) noexcept{
+			return static_cast<T&&>(*reinterpret_cast<std::remove_reference_t<T>*>(arg));
+		}
+
+		template<typename Result, typename Fn>
+		inline void store_result(void *result, Fn &&call){
+			if constexpr(std::is_void_v<Result>){
+				call();
+			}
+			else if(!result){
+				call();
+			}
+			else if constexpr(std::is_reference_v<Result>){
+				// bound first, `std::addressof` doesn't take the rvalue an `T&&` result is
+				auto &&ret = call();
+				*reinterpret_cast<std::remove_reference_t<Result>**>(result) = std::addressof(ret);
+			}
+			else{
+				new(result) Result(call());
+			}
+		}
+
+		template<auto Ptr, typename Ret, typename ... Params, std::size_t ... Is>
+		inline void invoke_function_impl(Ret(*)(Params...), void *const *args, void *result, std::index_sequence<Is...>){
+			(void)args;
+			store_result<Ret>(result, [&]() -> decltype(auto){ return Ptr(forward_arg<Params>(args[Is])...); });
+		}
+
+		template<auto Ptr, typename Ret, typename ... Params>
+		inline void invoke_function(Ret(*fn)(Params...), void *const *args, void *result){
+			invoke_function_impl<Ptr>(fn, args, result, std::index_sequence_for<Params...>());
+		}
+
 		template<typename Cls, std::size_t Idx>
-		struct class_member_impl final: class_member_helper{
+		struct REFLCPP_HIDDEN_SYMBOL class_member_impl final: class_member_helper{
 			using member_info = metapp::class_member<Cls, Idx>;
 
 			std::string_view name() const noexcept override{ return member_info::name; }
 
 			type_info type() const noexcept override{
-				static const auto ret = reflect<typename member_info::type>();
-				return ret;
+				return reflect<typename member_info::type>();
 			}
 
 			std::size_t num_attributes() const noexcept override{
@@ -497,7 +892,63 @@ namespace reflpp{
 
 			void *get(void *self) const noexcept override{
 				auto p = reinterpret_cast<Cls*>(self);
-				return &member_info::get(*p);
+				return const_cast<void*>(static_cast<const void*>(std::addressof(member_info::get(*p))));
+			}
+
+			bool is_standard_layout() const noexcept override{ return std::is_standard_layout_v<Cls>; }
+
+			std::size_t offset() const noexcept override{
+				if constexpr(!member_info::is_accessable || !std::is_standard_layout_v<Cls>){
+					return static_cast<std::size_t>(-1);
+				}
+				else if constexpr(member_info::offset != metapp::detail::unknown_offset){
+					return member_info::offset;
+				}
+				else{
+					static const std::size_t ret = member_offset(member_info::ptr);
+					return ret;
+				}
+			}
+
+			bool gather(const void *objs, std::size_t stride, std::size_t n, void *out) const override{
+				using member_type = typename member_info::type;
+
+				if constexpr(!member_info::is_accessable){
+					return false;
+				}
+				else if constexpr(std::is_trivially_copyable_v<member_type>){
+					if constexpr(std::is_standard_layout_v<Cls>){
+						strided_copy(reinterpret_cast<const unsigned char*>(objs) + offset(), stride, n, out, sizeof(member_type));
+					}
+					else{
+						auto src = reinterpret_cast<const unsigned char*>(objs);
+						auto dst = reinterpret_cast<unsigned char*>(out);
+
+						for(std::size_t i = 0; i < n; i++){
+							auto obj = reinterpret_cast<const Cls*>(src + (i * stride));
+							std::memcpy(dst + (i * sizeof(member_type)), std::addressof(obj->*member_info::ptr), sizeof(member_type));
+						}
+					}
+
+					return true;
+				}
+				else if constexpr(std::is_copy_constructible_v<member_type>){
+					// const members are still copied into mutable storage
+					using value_type = std::remove_cv_t<member_type>;
+
+					auto src = reinterpret_cast<const unsigned char*>(objs);
+					auto dst = reinterpret_cast<value_type*>(out);
+
+					for(std::size_t i = 0; i < n; i++){
+						auto obj = reinterpret_cast<const Cls*>(src + (i * stride));
+						new(dst + i) value_type(obj->*member_info::ptr);
+					}
+
+					return true;
+				}
+				else{
+					return false;
+				}
 			}
 		};
 
@@ -510,8 +961,7 @@ namespace reflpp{
 			}
 
 			type_info result_type() const noexcept override{
-				static const auto ret = reflect<typename method_info::result>();
-				return ret;
+				return reflect<typename method_info::result>();
 			}
 
 			std::size_t num_params() const noexcept override{
@@ -560,18 +1010,50 @@ namespace reflpp{
 						metapp::for_all<typename info::type>([&](auto inner_type){
 							using inner = metapp::get_t<decltype(inner_type)>;
 							if(offset++ != idx) return;
-							static const auto reflected = reflect<inner>();
-							ret = reflected;
+							ret = reflect<inner>();
 						});
 					}
 					else{
 						if(offset != idx) return;
-						static const auto reflected = reflect<typename info::type>();
-						ret = reflected;
+						ret = reflect<typename info::type>();
 					}
 				});
 				return ret;
 			}
+
+			bool is_static() const noexcept override{ return method_info::is_static; }
+
+			bool invoke(void *self, void *const *args, void *result) const override{
+				if constexpr(!method_info::is_accessable){
+					return false;
+				}
+				else{
+					using param_types = typename method_info::param_types;
+					invoke_impl(self, args, result, std::make_index_sequence<param_types::size>());
+					return true;
+				}
+			}
+
+			private:
+				template<std::size_t ... Is>
+				static void invoke_impl(void *self, void *const *args, void *result, std::index_sequence<Is...>){
+					using param_types = typename method_info::param_types;
+					using result_type = typename method_info::result;
+
+					(void)self;
+					(void)args;
+
+					const auto call = [&]() -> decltype(auto){
+						if constexpr(method_info::is_static){
+							return method_info::ptr(forward_arg<metapp::get_t<param_types, Is>>(args[Is])...);
+						}
+						else{
+							return (reinterpret_cast<Cls*>(self)->*method_info::ptr)(forward_arg<metapp::get_t<param_types, Is>>(args[Is])...);
+						}
+					};
+
+					store_result<result_type>(result, call);
+				}
 		};
 
 		struct class_info_helper: type_info_helper{
@@ -586,6 +1068,12 @@ namespace reflpp{
 
 			virtual void *cast_to_base(void *self, std::size_t idx) const noexcept = 0;
 
+			/**
+			 * @brief Get the layout fingerprint of the class, `0` if it is unknown.
+			 * @see metapp::class_info::layout_fingerprint
+			 */
+			virtual std::uint64_t layout_fingerprint() const noexcept = 0;
+
 			template<typename T>
 			T *cast_to(void *self_void, const class_info to = reflect<T>()) const noexcept{
 				if(this == to){
@@ -611,7 +1099,7 @@ namespace reflpp{
 		};
 
 		template<typename T>
-		struct class_info_impl final: info_helper_base<T, class_info_helper>{
+		struct REFLCPP_HIDDEN_SYMBOL class_info_impl final: info_helper_base<T, class_info_helper>{
 			using class_meta = metapp::class_info<T>;
 
 			std::size_t m_num_bases = 0;
@@ -630,6 +1118,8 @@ namespace reflpp{
 				register_type(this, true);
 			}
 
+			std::uint64_t layout_fingerprint() const noexcept override{ return class_meta::layout_fingerprint; }
+
 			std::size_t num_attributes() const noexcept override{ return class_meta::attributes::size; }
 
 			attribute_info attribute(std::size_t idx) const noexcept override{
@@ -838,7 +1328,7 @@ namespace reflpp{
 		};
 
 		template<typename T>
-		struct enum_info_impl: info_helper_base<T, enum_info_helper>{
+		struct REFLCPP_HIDDEN_SYMBOL enum_info_impl: info_helper_base<T, enum_info_helper>{
 			using enum_meta = metapp::enum_info<T>;
 
 			enum_info_impl(){ register_type(this, true); }
@@ -868,13 +1358,23 @@ namespace reflpp{
 
 		bool register_type(type_info info, bool overwrite = false);
 
+		/**
+		 * @brief Get the registered type with a type index, searching exported tables by id.
+		 * @param index type index to search for
+		 * @param id id of the type, e.g. `metapp::type_id<T>`
+		 * @returns `nullptr` if no such type is registered or exported
+		 */
+		type_info reflect_exact(std::type_index index, std::uint64_t id);
+
 		template<typename T>
-		struct reflect_simple{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_simple{
 			static auto reflect(){
 				if constexpr(std::is_class_v<T>){
 					struct class_info_impl final: info_helper_base<T, class_info_helper>{
 						class_info_impl(){ register_type(this); }
 
+						std::uint64_t layout_fingerprint() const noexcept override{ return 0; }
+
 						std::size_t num_methods() const noexcept override{ return 0; }
 						const class_method_helper *method(std::size_t) const noexcept override{ return nullptr; }
 
@@ -905,7 +1405,7 @@ namespace reflpp{
 		struct reflect_info;
 
 		template<typename Enum>
-		struct reflect_info<Enum, std::enable_if_t<std::is_enum_v<Enum>>>{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_info<Enum, std::enable_if_t<std::is_enum_v<Enum>>>{
 			static auto reflect(){
 				static const enum_info_impl<Enum> ret;
 				return &ret;
@@ -913,7 +1413,7 @@ namespace reflpp{
 		};
 
 		template<typename Class>
-		struct reflect_info<Class, std::enable_if_t<std::is_class_v<Class>>>{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_info<Class, std::enable_if_t<std::is_class_v<Class>>>{
 			static auto reflect(){
 				static const class_info_impl<Class> ret;
 				return &ret;
@@ -921,7 +1421,7 @@ namespace reflpp{
 		};
 
 		template<typename T>
-		struct reflect_helper<T, std::enable_if_t<std::is_reference_v<T>>>{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_helper<T, std::enable_if_t<std::is_reference_v<T>>>{
 			static type_info reflect(){
 				struct ref_info_impl final: ref_info_helper{
 					ref_info_impl(){ register_type(this); }
@@ -930,14 +1430,14 @@ namespace reflpp{
 					std::size_t alignment() const noexcept override{ return alignof(void*); }
 					void destroy(void *p) const noexcept override{ }
 					std::type_index type_index() const noexcept override{ return typeid(T); }
-					type_info refered() const noexcept override{ static auto ret = reflpp::reflect<std::remove_reference_t<T>>(); return ret; }
+					type_info refered() const noexcept override{ return reflpp::reflect<std::remove_reference_t<T>>(); }
 				} static ret;
 				return &ret;
 			}
 		};
 
 		template<typename T>
-		struct reflect_helper<T, std::enable_if_t<std::is_pointer_v<T> && !std::is_function_v<std::remove_pointer_t<T>>>>{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_helper<T, std::enable_if_t<std::is_pointer_v<T> && !std::is_function_v<std::remove_pointer_t<T>>>>{
 			static type_info reflect(){
 				struct ptr_info_impl final: ptr_info_helper{
 					ptr_info_impl(){ register_type(this); }
@@ -946,14 +1446,14 @@ namespace reflpp{
 					std::size_t alignment() const noexcept override{ return alignof(T); }
 					void destroy(void *p) const noexcept override{ }
 					std::type_index type_index() const noexcept override{ return typeid(T); }
-					type_info pointed() const noexcept override{ static auto ret = reflpp::reflect<std::remove_pointer_t<T>>(); return ret; }
+					type_info pointed() const noexcept override{ return reflpp::reflect<std::remove_pointer_t<T>>(); }
 				} static ret;
 				return &ret;
 			}
 		};
 
 		template<typename Ret, typename ... Args>
-		struct reflect_helper<Ret(*)(Args...), void>{
+		struct REFLCPP_HIDDEN_SYMBOL reflect_helper<Ret(*)(Args...), void>{
 			static fn_ptr_info reflect(){
 				struct fn_ptr_info_impl final: fn_ptr_info_helper{
 					fn_ptr_info_impl(){ register_type(this); }
@@ -1000,7 +1500,11 @@ namespace reflpp{
 
 		template<typename Int>
 		struct reflect_helper<Int, std::enable_if_t<std::is_integral_v<Int>>>{
-			static reflpp::int_info reflect(){ return detail::int_info(sizeof(Int) * CHAR_BIT, std::is_signed_v<Int>); }
+			static reflpp::int_info reflect(){
+				// kept apart from `std::uint8_t` so runtime code can tell which values are valid
+				if constexpr(std::is_same_v<Int, bool>) return detail::bool_info();
+				else return detail::int_info(sizeof(Int) * CHAR_BIT, std::is_signed_v<Int>);
+			}
 		};
 
 		template<typename Float>
@@ -1011,7 +1515,10 @@ namespace reflpp{
 		template<typename T>
 		struct reflect_helper<T, std::enable_if_t<std::is_class_v<T>>>{
 			static class_info reflect(){
-				if(auto ret = reflect_class(metapp::type_name<T>); ret){
+				auto ret = dynamic_cast<class_info>(reflect_exact(typeid(T), metapp::type_id<T>));
+				if(!ret) ret = reflect_class(metapp::type_name<T>);
+
+				if(ret){
 					if constexpr(metapp::has_info<T>){
 						auto elaborated = dynamic_cast<const class_info_impl<T>*>(ret);
 						if(!elaborated){
@@ -1034,7 +1541,10 @@ namespace reflpp{
 
 		template<typename T>
 		struct reflect_helper<T, std::enable_if_t<std::is_enum_v<T>>>{
-			static enum_info reflect(){ return reflect_enum(metapp::type_name<T>); }
+			static enum_info reflect(){
+				auto ret = dynamic_cast<enum_info>(reflect_exact(typeid(T), metapp::type_id<T>));
+				return ret ? ret : reflect_enum(metapp::type_name<T>);
+			}
 		};
 
 		template<typename T>
@@ -1046,106 +1556,626 @@ namespace reflpp{
 		using type_export_fn = type_info(*)();
 		using function_export_fn = function_info(*)();
 
-		static void *aligned_alloc(std::size_t align, std::size_t len){
-#ifdef __linux__
-			return ::aligned_alloc(align, len);
-#elif defined(_WIN32)
-			return _aligned_malloc(len, align);
-#else
-			return std::aligned_alloc(align, len);
-#endif
-		}
+		/**
+		 * @brief Entry in a statically generated table of exported types.
+		 */
+		struct type_export_entry{
+			std::uint64_t id;
+			std::string_view name;
+			const std::type_info *type;
+			type_export_fn fn;
+			std::uint64_t layout_fingerprint;
+		};
 
-		static void aligned_free(void *p){
-#ifdef __linux__
-			::free(p);
-#elif defined(_WIN32)
-			_aligned_free(p);
-#else
-			std::free(p);
-#endif
+		template<typename T>
+		constexpr type_export_entry make_type_export_entry() noexcept{
+			return { metapp::type_id<T>, metapp::type_name<T>, &typeid(T), &type_export<T>, metapp::layout_fingerprint<T> };
 		}
-	}
-
-	/**
-	 * @brief Class for dynamically creating values of statically-unknown types.
-	 * @tparam Base base class of all created values or `void` for any value.
-	 */
-	template<typename Base = void, template<typename> class AllocT = std::allocator>
-	class alignas(16) value{
-		public:
-			using info_type = std::conditional_t<std::is_same_v<Base, void>, type_info, class_info>;
 
-			value() = default;
+		template<std::size_t N>
+		constexpr std::array<type_export_entry, N> sort_type_table(std::array<type_export_entry, N> entries) noexcept{
+			for(std::size_t i = 1; i < N; i++){
+				const auto entry = entries[i];
 
-			template<typename T, typename ... Args>
-			value(metapp::type<T>, Args &&... args)
-				: m_type(reflect<T>())
-			{
-				if constexpr(sizeof(T) <= 16 && alignof(T) <= 16){
-					new(m_storage.bytes) T(std::forward<Args>(args)...);
-					m_destroy_fn = [](void *mem, info_type){
-						auto ptr = reinterpret_cast<T*>(mem);
-						std::destroy_at(ptr);
-					};
+				std::size_t j = i;
+				for(; j > 0 && entries[j - 1].id > entry.id; j--){
+					entries[j] = entries[j - 1];
 				}
-				else{
-					using aligned_storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
-					AllocT<aligned_storage> alloc;
 
-					m_storage.pointer = alloc.allocate(1);
-					m_destroy_fn = [](void *mem, info_type){
-						AllocT<aligned_storage> alloc;
+				entries[j] = entry;
+			}
 
-						auto ptr = reinterpret_cast<T*>(mem);
-						std::destroy_at(ptr);
-						alloc.deallocate(reinterpret_cast<aligned_storage*>(mem), 1);
-					};
+			return entries;
+		}
+
+		/**
+		 * @brief Entry in a statically generated table of exported functions.
+		 */
+		struct function_export_entry{
+			std::string_view name;
+			function_export_fn fn;
+		};
+
+		constexpr std::string_view strip_global_scope(std::string_view name) noexcept{
+			return name.substr(0, 2) == "::" ? name.substr(2) : name;
+		}
+
+		template<std::size_t N>
+		constexpr std::array<function_export_entry, N> sort_function_table(std::array<function_export_entry, N> entries) noexcept{
+			for(std::size_t i = 1; i < N; i++){
+				const auto entry = entries[i];
+
+				std::size_t j = i;
+				for(; j > 0 && strip_global_scope(entries[j - 1].name) > strip_global_scope(entry.name); j--){
+					entries[j] = entries[j - 1];
 				}
-			}
 
-			template<typename ... Args>
-			explicit value(info_type type_, Args &&... args)
-				: m_type(nullptr)
-			{
-				construct(type_, std::forward<Args>(args)...);
+				entries[j] = entry;
 			}
 
-			value(const value&) = delete;
+			return entries;
+		}
 
-			template<typename Derived, template<typename> class AllocU>
-			value(value<Derived, AllocU> &&other) noexcept{
-				if constexpr(std::is_class_v<Base>){
-					static_assert(std::is_base_of_v<Base, Derived>);
+		/**
+		 * @brief Add a table of exported functions to the registry.
+		 * @note Functions in the table are only instantiated when first looked up.
+		 * @warning The table must stay alive for the life of the program or until unloaded.
+		 */
+		void register_function_table(const function_export_entry *entries, std::size_t n);
+
+		bool register_function(function_info info);
+
+		/**
+		 * @brief Type and function tables generated for a single reflected header.
+		 */
+		struct export_tables{
+			const type_export_entry *types;
+			std::size_t num_types;
+			const function_export_entry *functions;
+			std::size_t num_functions;
+		};
+
+		/**
+		 * @brief Every export table in a library, returned by the library entry point.
+		 */
+		struct library_exports{
+			const export_tables *const *tables;
+			std::size_t num_tables;
+		};
+
+		using library_exports_fn = const library_exports*(*)();
+
+		/**
+		 * @brief Get every export table registered from within an address range, e.g. a library's segments.
+		 * @note Tables of reflected static libraries are only reachable this way, the entry point lists a module's own headers.
+		 */
+		std::vector<export_tables> registered_tables(const void *begin, const void *end);
+
+		/**
+		 * @brief Name of the `extern "C"` entry point reflpp generates for each library.
+		 */
+		inline constexpr const char *library_exports_symbol = "reflpp_library_exports";
+
+		/**
+		 * @brief Name of the section generated type manifests are placed in.
+		 */
+		inline constexpr const char *manifest_section_name = ".reflpp_manifest";
+
+		inline constexpr std::uint32_t manifest_magic = 0x4d4c4652; // "RFLM"
+
+		enum class manifest_kind: std::uint32_t{
+			class_, enum_
+		};
+
+		/**
+		 * @brief Header of a type record in a plugin manifest.
+		 * Followed by the null terminated type name (`name_size` excludes the terminator) and `attributes_size` bytes of attributes.
+		 * Each attribute is its null terminated scoped name, a byte holding the number of arguments, then each argument null terminated.
+		 * Records are 8 byte aligned and `record_size` includes any padding.
+		 */
+		struct manifest_record{
+			std::uint32_t magic;
+			std::uint32_t record_size;
+			std::uint64_t id;
+			std::uint64_t layout_fingerprint;
+			std::uint32_t size;
+			std::uint32_t alignment;
+			manifest_kind kind;
+			std::uint32_t num_attributes;
+			std::uint32_t name_size;
+			std::uint32_t attributes_size;
+		};
+
+		template<std::size_t N>
+		struct alignas(8) manifest_entry{
+			manifest_record header;
+			char strings[N];
+		};
+
+		constexpr char *write_manifest_str(char *out, std::string_view str) noexcept{
+			for(char c : str){
+				*out++ = c;
+			}
+
+			*out++ = '\0';
+			return out;
+		}
+
+		template<typename Args>
+		struct manifest_attrib_args;
+
+		template<typename ... Args>
+		struct manifest_attrib_args<metapp::types<Args...>>{
+			static_assert(sizeof...(Args) <= UCHAR_MAX, "too many attribute arguments for a manifest");
+
+			static constexpr std::size_t count = sizeof...(Args);
+			static constexpr std::size_t size = ((Args::value.size() + 1) + ... + 0);
+
+			static constexpr char *write(char *out) noexcept{
+				((out = write_manifest_str(out, Args::value)), ...);
+				return out;
+			}
+		};
+
+		/**
+		 * @brief Writes an attribute as its name, a byte holding the number of arguments, then each argument.
+		 * Arguments are counted rather than terminated, so an empty argument can't end the list.
+		 */
+		template<typename Attrib>
+		struct manifest_attrib{
+			using args = manifest_attrib_args<typename Attrib::args>;
+
+			static constexpr std::size_t scope_size = Attrib::scope.empty() ? 0 : Attrib::scope.size() + 2;
+			static constexpr std::size_t size = scope_size + Attrib::name.size() + 1 + 1 + args::size;
+
+			static constexpr char *write(char *out) noexcept{
+				if constexpr(scope_size != 0){
+					for(char c : Attrib::scope) *out++ = c;
+					*out++ = ':';
+					*out++ = ':';
 				}
-				else if constexpr(!std::is_same_v<Base, void>){
-					static_assert(std::is_same_v<Base, Derived>);
+
+				out = write_manifest_str(out, Attrib::name);
+				*out++ = static_cast<char>(args::count);
+				return args::write(out);
+			}
+		};
+
+		template<typename Attribs>
+		struct manifest_attribs;
+
+		template<typename ... Attribs>
+		struct manifest_attribs<metapp::types<Attribs...>>{
+			static constexpr std::size_t count = sizeof...(Attribs);
+			static constexpr std::size_t size = (manifest_attrib<Attribs>::size + ... + 0);
+
+			static constexpr char *write(char *out) noexcept{
+				((out = manifest_attrib<Attribs>::write(out)), ...);
+				return out;
+			}
+		};
+
+		template<typename T, typename = void>
+		struct manifest_attributes{
+			using type = metapp::types<>;
+		};
+
+		template<typename T>
+		struct manifest_attributes<T, std::enable_if_t<metapp::has_info<T>>>{
+			using type = typename metapp::class_info<T>::attributes;
+		};
+
+		/**
+		 * @brief Build the manifest record for a type at compile time.
+		 */
+		template<typename T>
+		constexpr auto make_manifest_entry() noexcept{
+			using attribs = manifest_attribs<typename manifest_attributes<T>::type>;
+
+			constexpr auto name = metapp::type_name<T>;
+
+			manifest_entry<name.size() + 1 + attribs::size> ret{};
+
+			ret.header.magic = manifest_magic;
+			ret.header.record_size = static_cast<std::uint32_t>(sizeof(ret));
+			ret.header.id = metapp::type_id<T>;
+			ret.header.layout_fingerprint = metapp::layout_fingerprint<T>;
+			ret.header.size = static_cast<std::uint32_t>(sizeof(T));
+			ret.header.alignment = static_cast<std::uint32_t>(alignof(T));
+			ret.header.kind = std::is_enum_v<T> ? manifest_kind::enum_ : manifest_kind::class_;
+			ret.header.num_attributes = static_cast<std::uint32_t>(attribs::count);
+			ret.header.name_size = static_cast<std::uint32_t>(name.size());
+			ret.header.attributes_size = static_cast<std::uint32_t>(attribs::size);
+
+			attribs::write(write_manifest_str(ret.strings, name));
+
+			return ret;
+		}
+
+		/**
+		 * @brief Add a table of exported types to the registry.
+		 * @note Types in the table are only instantiated when first looked up.
+		 * @warning The table must stay alive for the life of the program or until unloaded.
+		 */
+		void register_type_table(const type_export_entry *entries, std::size_t n);
+
+		/**
+		 * @brief Remove every type, function and export table whose data lies within `[begin, end)`.
+		 * Used to drop everything a library registered before it is unloaded.
+		 */
+		void deregister_range(const void *begin, const void *end);
+
+		/**
+		 * @brief Get the layout fingerprint of the class registered with `id`, ignoring every entity within the `excluded` ranges.
+		 * Pending types are compared through their export entries, so nothing is instantiated.
+		 * @returns The fingerprint, or `0` if no class with a known layout is registered.
+		 */
+		std::uint64_t registered_layout_fingerprint(std::uint64_t id, const std::vector<std::pair<const void*, const void*>> &excluded);
+
+		/**
+		 * @brief Holds the type and function registries locked for the lifetime of the object.
+		 * Lookups and registrations from other threads wait until it is destroyed,
+		 * so a set of entities can be replaced atomically. May be nested.
+		 */
+		class registry_lock{
+			public:
+				registry_lock();
+				~registry_lock();
+
+				registry_lock(const registry_lock&) = delete;
+				registry_lock &operator=(const registry_lock&) = delete;
+		};
+
+		/**
+		 * @brief Holds back every registration made by the current thread for the lifetime of the object,
+		 * so a library can be opened and collected without lookups seeing any of its entities until `publish` is called.
+		 * Anything not published is dropped. May be nested.
+		 */
+		class registration_stage{
+			public:
+				registration_stage();
+				~registration_stage();
+
+				registration_stage(const registration_stage&) = delete;
+				registration_stage &operator=(const registration_stage&) = delete;
+
+				/**
+				 * @brief Add everything held back to the registry and stop staging.
+				 * @note Call with a `registry_lock` held to replace other entities in the same step.
+				 */
+				void publish();
+
+			private:
+				void stop() noexcept;
+
+				registration_stage *m_prev;
+				bool m_active = true;
+
+				std::vector<std::pair<const type_export_entry*, std::size_t>> m_type_tables;
+				std::vector<std::pair<const function_export_entry*, std::size_t>> m_function_tables;
+				std::vector<std::pair<type_info, bool>> m_types;
+				std::vector<function_info> m_fns;
+
+				friend void register_type_table(const type_export_entry *entries, std::size_t n);
+				friend void register_function_table(const function_export_entry *entries, std::size_t n);
+				friend bool register_type(type_info info, bool overwrite);
+				friend bool register_function(function_info info);
+				friend std::vector<export_tables> registered_tables(const void *begin, const void *end);
+		};
+	}
+
+	namespace detail{
+		/**
+		 * @brief Get the object a method is called on, which may be passed by reference or pointer.
+		 */
+		template<typename T>
+		inline void *erase_self(T &&self) noexcept{
+			if constexpr(std::is_null_pointer_v<std::decay_t<T>>){
+				return nullptr;
+			}
+			else if constexpr(std::is_pointer_v<std::decay_t<T>>){
+				return const_cast<void*>(static_cast<const void*>(self));
+			}
+			else{
+				return const_cast<void*>(static_cast<const void*>(std::addressof(self)));
+			}
+		}
+
+		/**
+		 * @brief Get the address of an argument, which `forward_arg` reads as the parameter type.
+		 */
+		template<typename T>
+		inline void *erase_arg(T &&arg) noexcept{
+			return const_cast<void*>(static_cast<const void*>(std::addressof(arg)));
+		}
+
+		/**
+		 * @brief Turn arguments that can't be read through their address as the parameter type into ones that can.
+		 *
+		 * Arrays (e.g. string literals) decay to pointers and `nullptr` becomes a null `void*`,
+		 * which has the same representation as every other null object pointer.
+		 */
+		template<typename T>
+		inline decltype(auto) decay_arg(T &&arg) noexcept{
+			using arg_type = std::remove_reference_t<T>;
+
+			if constexpr(std::is_array_v<arg_type>){
+				return std::decay_t<T>(arg);
+			}
+			else if constexpr(std::is_null_pointer_v<std::remove_cv_t<arg_type>>){
+				return static_cast<void*>(nullptr);
+			}
+			else{
+				return std::forward<T>(arg);
+			}
+		}
+
+		/**
+		 * @brief Call `invoke(void *result)` with storage for a result of type `R` and return the result.
+		 */
+		template<typename R, typename Invoke>
+		R invoke_erased(Invoke &&invoke, const char *err){
+			if constexpr(std::is_void_v<R>){
+				if(!invoke(nullptr)){
+					throw std::runtime_error(err);
+				}
+			}
+			else if constexpr(std::is_reference_v<R>){
+				std::remove_reference_t<R> *ret = nullptr;
+				if(!invoke(&ret)){
+					throw std::runtime_error(err);
 				}
 
-				m_type = std::exchange(other.m_type, nullptr);
-				m_destroy_fn = std::exchange(other.m_destroy_fn, [](auto...){});
+				return static_cast<R>(*ret);
+			}
+			else{
+				alignas(R) unsigned char storage[sizeof(R)];
+				if(!invoke(storage)){
+					throw std::runtime_error(err);
+				}
 
-				if(!m_type){
+				auto ret_ptr = std::launder(reinterpret_cast<R*>(storage));
+				R ret = std::move(*ret_ptr);
+				std::destroy_at(ret_ptr);
+				return ret;
+			}
+		}
+
+		template<typename R, typename ... Args>
+		R invoke_function_erased(function_info fn, Args &&... args){
+			if(fn->num_params() != sizeof...(Args)){
+				throw std::runtime_error("Could not invoke function, wrong number of arguments");
+			}
+
+			void *const arg_ptrs[sizeof...(Args) + 1] = { erase_arg(args)..., nullptr };
+			return invoke_erased<R>([&](void *result){ return fn->invoke(arg_ptrs, result); }, "Could not invoke function");
+		}
+
+		template<typename R, typename ... Args>
+		R invoke_method_erased(class_method_info method, void *self, Args &&... args){
+			if(method->num_params() != sizeof...(Args)){
+				throw std::runtime_error("Could not invoke method, wrong number of arguments");
+			}
+
+			void *const arg_ptrs[sizeof...(Args) + 1] = { erase_arg(args)..., nullptr };
+			return invoke_erased<R>([&](void *result){ return method->invoke(self, arg_ptrs, result); }, "Could not invoke method");
+		}
+	}
+
+	/**
+	 * @brief Call a reflected function without packing arguments.
+	 * @note Arguments are forwarded as their declared parameter types, so by-value and rvalue reference parameters may be moved from.
+	 * @warning Argument types are not checked against the function signature, only their number.
+	 * @throws std::runtime_error if the number of arguments doesn't match or the function could not be called
+	 * @tparam R result type of the function
+	 * @param fn function to call
+	 * @param args arguments to pass to the function
+	 * @returns the result of the call
+	 */
+	template<typename R, typename ... Args>
+	R invoke(function_info fn, Args &&... args){
+		return detail::invoke_function_erased<R>(fn, detail::decay_arg(std::forward<Args>(args))...);
+	}
+
+	/**
+	 * @brief Call a reflected method without packing arguments.
+	 * @note Arguments are forwarded as their declared parameter types, so by-value and rvalue reference parameters may be moved from.
+	 * @warning Argument types are not checked against the method signature, only their number.
+	 * @throws std::runtime_error if the number of arguments doesn't match or the method could not be called
+	 * @tparam R result type of the method
+	 * @param method method to call
+	 * @param self object (or pointer to object) to call the method on, ignored for static methods
+	 * @param args arguments to pass to the method
+	 * @returns the result of the call
+	 */
+	template<typename R, typename Self, typename ... Args>
+	R invoke(class_method_info method, Self &&self, Args &&... args){
+		return detail::invoke_method_erased<R>(method, detail::erase_self(self), detail::decay_arg(std::forward<Args>(args))...);
+	}
+
+	namespace detail{
+		template<std::size_t Align>
+		struct alignas(Align) aligned_block{
+			unsigned char bytes[Align];
+		};
+
+		inline constexpr std::size_t max_block_alignment = 4096;
+
+		/**
+		 * @brief Allocate `size` bytes aligned to `align` through any standard allocator.
+		 */
+		template<std::size_t Align = 1, typename Alloc>
+		void *allocate_aligned(const Alloc &alloc, std::size_t size, std::size_t align){
+			if constexpr(Align < max_block_alignment){
+				if(align > Align){
+					return allocate_aligned<Align * 2>(alloc, size, align);
+				}
+			}
+			else if(align > Align){
+				throw std::bad_alloc();
+			}
+
+			using block_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<aligned_block<Align>>;
+			block_alloc_type block_alloc(alloc);
+			return std::allocator_traits<block_alloc_type>::allocate(block_alloc, (size + Align - 1) / Align);
+		}
+
+		template<std::size_t Align = 1, typename Alloc>
+		void deallocate_aligned(const Alloc &alloc, void *p, std::size_t size, std::size_t align) noexcept{
+			if constexpr(Align < max_block_alignment){
+				if(align > Align){
+					deallocate_aligned<Align * 2>(alloc, p, size, align);
 					return;
 				}
+			}
+
+			using block_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<aligned_block<Align>>;
+			block_alloc_type block_alloc(alloc);
+			std::allocator_traits<block_alloc_type>::deallocate(block_alloc, reinterpret_cast<aligned_block<Align>*>(p), (size + Align - 1) / Align);
+		}
+
+		template<typename Alloc, bool = std::is_empty_v<Alloc> && !std::is_final_v<Alloc>>
+		class alloc_holder{
+			public:
+				alloc_holder() = default;
+
+				explicit alloc_holder(const Alloc &alloc_) noexcept
+					: m_alloc(alloc_){}
+
+				const Alloc &allocator() const noexcept{ return m_alloc; }
+
+				void reset_allocator(const Alloc &alloc_) noexcept{
+					std::destroy_at(&m_alloc);
+					new(&m_alloc) Alloc(alloc_);
+				}
+
+			private:
+				Alloc m_alloc;
+		};
+
+		template<typename Alloc>
+		class alloc_holder<Alloc, true>: private Alloc{
+			public:
+				alloc_holder() = default;
+
+				explicit alloc_holder(const Alloc &alloc_) noexcept
+					: Alloc(alloc_){}
+
+				const Alloc &allocator() const noexcept{ return *this; }
+
+				void reset_allocator(const Alloc&) noexcept{}
+		};
+	}
+
+	/**
+	 * @brief Class for dynamically creating values of statically-unknown types.
+	 * @note Moving a value transfers its allocator along with its storage.
+	 * @note Only nothrow relocatable types are stored inline; copying throws if the contained type is not copy constructible.
+	 * @tparam Base base class of all created values or `void` for any value.
+	 * @tparam AllocT allocator used for values that don't fit inline, e.g. `std::pmr::polymorphic_allocator`.
+	 * @tparam SmallSize size of the inline buffer.
+	 */
+	template<typename Base = void, template<typename> class AllocT = std::allocator, std::size_t SmallSize = METACPP_SMALL_SIZE>
+	class alignas(16) value: private detail::alloc_holder<AllocT<unsigned char>>{
+		public:
+			using info_type = std::conditional_t<std::is_same_v<Base, void>, type_info, class_info>;
+			using allocator_type = AllocT<unsigned char>;
 
-				if(m_type->size() <= 16 && m_type->alignment() <= 16){
-					std::memcpy(m_storage.bytes, other.m_storage.bytes, m_type->size());
-					//std::memset(other.m_storage.bytes, 0, m_type->size());
+			static constexpr std::size_t small_size = SmallSize;
+			static constexpr std::size_t small_alignment = 16;
+
+			value() = default;
+
+			explicit value(const allocator_type &alloc) noexcept
+				: alloc_base(alloc){}
+
+			template<typename T, typename ... Args>
+			value(metapp::type<T> type_, Args &&... args)
+				: value(std::allocator_arg, allocator_type(), type_, std::forward<Args>(args)...)
+			{}
+
+			template<typename T, typename ... Args>
+			value(std::allocator_arg_t, const allocator_type &alloc, metapp::type<T>, Args &&... args)
+				: alloc_base(alloc)
+			{
+				if constexpr(fits_inline(sizeof(T), alignof(T)) && (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)){
+					new(m_storage.bytes) T(std::forward<Args>(args)...);
+					m_is_inline = true;
+					m_is_trivial = is_trivially_relocatable_v<T>;
 				}
 				else{
-					m_storage.pointer = std::exchange(other.m_storage.pointer, nullptr);
+					void *mem = detail::allocate_aligned(this->allocator(), sizeof(T), alignof(T));
+
+					try{
+						new(mem) T(std::forward<Args>(args)...);
+					}
+					catch(...){
+						detail::deallocate_aligned(this->allocator(), mem, sizeof(T), alignof(T));
+						throw;
+					}
+
+					m_storage.pointer = mem;
+					m_is_inline = false;
+				}
+
+				m_destroy_fn = [](void *mem, type_info){
+					auto ptr = reinterpret_cast<T*>(mem);
+					std::destroy_at(ptr);
+				};
+
+				m_type = reflect<T>();
+			}
+
+			template<typename ... Args>
+			explicit value(info_type type_, Args &&... args)
+				: m_type(nullptr)
+			{
+				construct(type_, std::forward<Args>(args)...);
+			}
+
+			template<typename ... Args>
+			value(std::allocator_arg_t, const allocator_type &alloc, info_type type_, Args &&... args)
+				: alloc_base(alloc)
+				, m_type(nullptr)
+			{
+				construct(type_, std::forward<Args>(args)...);
+			}
+
+			value(const value &other)
+				: alloc_base(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator()))
+			{
+				copy(other);
+			}
+
+			template<typename Derived>
+			value(value<Derived, AllocT, SmallSize> &&other) noexcept
+				: alloc_base(other.allocator())
+			{
+				if constexpr(std::is_class_v<Base>){
+					static_assert(std::is_base_of_v<Base, Derived>);
+				}
+				else if constexpr(!std::is_same_v<Base, void>){
+					static_assert(std::is_same_v<Base, Derived>);
 				}
+
+				take(other);
 			}
 
 			~value(){
 				destroy();
 			}
 
-			value &operator=(const value&) = delete;
+			value &operator=(const value &other){
+				if(this == &other) return *this;
+
+				destroy();
+				copy(other);
+
+				return *this;
+			}
 
-			template<typename Derived, template<typename> class AllocU>
-			value &operator=(value<Derived, AllocU> &&other) noexcept{
+			template<typename Derived>
+			value &operator=(value<Derived, AllocT, SmallSize> &&other) noexcept{
 				if constexpr(std::is_same_v<Base, Derived>){
 					if(this == &other) return *this;
 				}
@@ -1158,18 +2188,9 @@ namespace reflpp{
 
 				destroy();
 
-				m_type = std::exchange(other.m_type, nullptr);
-				m_destroy_fn = std::exchange(other.m_destroy_fn, [](auto...){});
+				this->reset_allocator(other.allocator());
 
-				if(m_type){
-					if(m_type->size() <= 16 && m_type->alignment() <= 16){
-						std::memcpy(m_storage.bytes, other.m_storage.bytes, m_type->size());
-						//std::memset(other.m_storage.bytes, 0, m_type->size());
-					}
-					else{
-						m_storage.pointer = std::exchange(other.m_storage.pointer, nullptr);
-					}
-				}
+				take(other);
 
 				return *this;
 			}
@@ -1182,11 +2203,48 @@ namespace reflpp{
 			 */
 			bool is_valid() const noexcept{ return !!m_type; }
 
+			/**
+			 * @brief Check if the contained value is stored in the inline buffer.
+			 */
+			bool is_inline() const noexcept{ return m_is_inline; }
+
 			/**
 			 * @brief Get the type of the contained value.
 			 */
 			info_type type() const noexcept{ return m_type; }
 
+			/**
+			 * @brief Get the allocator used for values that don't fit inline.
+			 */
+			allocator_type get_allocator() const noexcept{ return this->allocator(); }
+
+			/**
+			 * @brief Hash the contained value through its type info.
+			 * @note Values of types that aren't hashable only hash their type.
+			 */
+			std::size_t hash() const noexcept{
+				if(!m_type) return 0;
+				return static_cast<std::size_t>(metapp::detail::hash_combine(m_type->id(), m_type->hash(ptr())));
+			}
+
+			/**
+			 * @brief Check if two values have the same type and compare equal.
+			 */
+			template<typename OtherBase, template<typename> class AllocU, std::size_t SmallU>
+			bool operator==(const value<OtherBase, AllocU, SmallU> &other) const{
+				const type_info lhs_type = m_type, rhs_type = other.m_type;
+
+				if(lhs_type != rhs_type) return false;
+				else if(!lhs_type) return true;
+
+				return lhs_type->equal(ptr(), other.ptr());
+			}
+
+			template<typename OtherBase, template<typename> class AllocU, std::size_t SmallU>
+			bool operator!=(const value<OtherBase, AllocU, SmallU> &other) const{
+				return !(*this == other);
+			}
+
 			/**
 			 * @brief Try to get the value as a specified type.
 			 */
@@ -1232,79 +2290,705 @@ namespace reflpp{
 			}
 
 		private:
+			using alloc_base = detail::alloc_holder<allocator_type>;
+
+			static constexpr bool fits_inline(std::size_t size, std::size_t align) noexcept{
+				return size <= SmallSize && align <= small_alignment;
+			}
+
+			template<typename Derived>
+			void take(value<Derived, AllocT, SmallSize> &other) noexcept{
+				m_type = std::exchange(other.m_type, nullptr);
+				m_destroy_fn = std::exchange(other.m_destroy_fn, [](auto...){});
+				m_is_inline = std::exchange(other.m_is_inline, true);
+				m_is_trivial = std::exchange(other.m_is_trivial, true);
+
+				if(!m_type){
+					return;
+				}
+
+				if(m_is_inline){
+					if(m_is_trivial){
+						std::memcpy(m_storage.bytes, other.m_storage.bytes, SmallSize);
+					}
+					else{
+						// inline values are always nothrow relocatable
+						m_type->relocate(m_storage.bytes, other.m_storage.bytes);
+					}
+				}
+				else{
+					m_storage.pointer = std::exchange(other.m_storage.pointer, nullptr);
+				}
+			}
+
 			void destroy(){
 				if(!m_type) return;
 
-				m_destroy_fn(ptr(), m_type);
+				void *mem = ptr();
+
+				m_destroy_fn(mem, m_type);
+
+				if(!m_is_inline){
+					detail::deallocate_aligned(this->allocator(), mem, m_type->size(), m_type->alignment());
+				}
 
 				m_type = nullptr;
+				m_is_inline = true;
+				m_is_trivial = true;
 				m_destroy_fn = [](auto...){};
 			}
 
+			void copy(const value &other){
+				if(!other.m_type) return;
+
+				const type_info type_ = other.m_type;
+
+				if(other.m_is_inline){
+					if(!type_->copy_construct(m_storage.bytes, other.m_storage.bytes)){
+						throw std::runtime_error("Could not copy value");
+					}
+				}
+				else{
+					const std::size_t size = type_->size();
+					const std::size_t align = type_->alignment();
+
+					void *mem = detail::allocate_aligned(this->allocator(), size, align);
+					void *res = nullptr;
+
+					try{
+						res = type_->copy_construct(mem, other.m_storage.pointer);
+					}
+					catch(...){
+						detail::deallocate_aligned(this->allocator(), mem, size, align);
+						throw;
+					}
+
+					if(!res){
+						detail::deallocate_aligned(this->allocator(), mem, size, align);
+						throw std::runtime_error("Could not copy value");
+					}
+
+					m_storage.pointer = mem;
+				}
+
+				m_destroy_fn = other.m_destroy_fn;
+				m_is_inline = other.m_is_inline;
+				m_is_trivial = other.m_is_trivial;
+				m_type = other.m_type;
+			}
+
 			template<typename ... Args>
 			void construct(info_type type_, Args &&... args){
 				destroy();
 
 				auto pack = pack_args(std::forward<Args>(args)...);
 
-				if(type_->size() <= 16 && type_->alignment() <= 16){
-					std::memset(m_storage.bytes, 0, type_->size());
+				const std::size_t size = type_->size();
+				const std::size_t align = type_->alignment();
+
+				if(fits_inline(size, align) && type_->is_nothrow_relocatable()){
+					std::memset(m_storage.bytes, 0, size);
 					if(!type_->construct(m_storage.bytes, &pack)){
 						throw std::runtime_error("Could not construct small value");
 					}
 
-					m_destroy_fn = [](void *mem, info_type info){
-						info->destroy(mem);
-					};
+					m_is_inline = true;
+					m_is_trivial = type_->is_trivially_relocatable();
 				}
 				else{
-					m_storage.pointer = detail::aligned_alloc(type_->alignment(), type_->size());
-					if(!type_->construct(m_storage.pointer, &pack)){
+					void *mem = detail::allocate_aligned(this->allocator(), size, align);
+					if(!type_->construct(mem, &pack)){
+						detail::deallocate_aligned(this->allocator(), mem, size, align);
 						throw std::runtime_error("Could not construct value");
 					}
 
-					m_destroy_fn = [](void *mem, info_type info){
-						info->destroy(mem);
-						detail::aligned_free(mem);
-					};
+					m_storage.pointer = mem;
+					m_is_inline = false;
 				}
 
+				m_destroy_fn = [](void *mem, type_info info){
+					info->destroy(mem);
+				};
+
 				m_type = type_;
 			}
 
 			void *ptr() noexcept{
-				if(!m_type) return nullptr;
-
-				if(m_type->size() <= 16 && m_type->alignment() <= 16){
-					return m_storage.bytes;
-				}
-				else{
-					return m_storage.pointer;
-				}
+				return m_is_inline ? static_cast<void*>(m_storage.bytes) : m_storage.pointer;
 			}
 
 			const void *ptr() const noexcept{
-				if(!m_type) return nullptr;
-
-				if(m_type->size() <= 16 && m_type->alignment() <= 16){
-					return m_storage.bytes;
-				}
-				else{
-					return m_storage.pointer;
-				}
+				return m_is_inline ? static_cast<const void*>(m_storage.bytes) : m_storage.pointer;
 			}
 
 			info_type m_type = nullptr;
-			void(*m_destroy_fn)(void*, info_type);
+			void(*m_destroy_fn)(void*, type_info);
+			bool m_is_inline = true;
+			bool m_is_trivial = true;
 
 			union storage_t{
 				void *pointer;
-				unsigned char bytes alignas(16)[16];
+				unsigned char bytes alignas(16)[SmallSize > 0 ? SmallSize : 1];
 			} m_storage;
 
-			template<typename UBase, template<typename> class AllocU>
+			template<typename UBase, template<typename> class AllocU, std::size_t SmallU>
 			friend class value;
 	};
+
+	namespace pmr{
+		/**
+		 * @brief Value type that allocates from a `std::pmr::memory_resource`.
+		 */
+		template<typename Base = void, std::size_t SmallSize = METACPP_SMALL_SIZE>
+		using value = reflpp::value<Base, std::pmr::polymorphic_allocator, SmallSize>;
+	}
+
+	/**
+	 * @brief Contiguous array of values of a single statically-unknown type.
+	 * @note Elements are packed with a stride of `type()->size()`, so they can't be accessed as a base class.
+	 * @tparam AllocT allocator used for the element buffer.
+	 */
+	template<template<typename> class AllocT = std::allocator>
+	class value_vector: private detail::alloc_holder<AllocT<unsigned char>>{
+		public:
+			using allocator_type = AllocT<unsigned char>;
+
+			explicit value_vector(type_info type_, const allocator_type &alloc = allocator_type())
+				: alloc_base(alloc)
+				, m_type(type_)
+			{
+				if(!m_type || m_type->size() == 0){
+					throw std::runtime_error("Can not create a value_vector of an unsized type");
+				}
+			}
+
+			value_vector(const value_vector &other)
+				: value_vector(other.m_type, std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator()))
+			{
+				reserve(other.m_size);
+
+				const std::size_t stride_ = stride();
+
+				for(; m_size < other.m_size; ++m_size){
+					if(!m_type->copy_construct(m_data + (m_size * stride_), other.m_data + (m_size * stride_))){
+						throw std::runtime_error("Could not copy value");
+					}
+				}
+			}
+
+			value_vector(value_vector &&other) noexcept
+				: alloc_base(other.allocator())
+				, m_type(other.m_type)
+				, m_data(std::exchange(other.m_data, nullptr))
+				, m_size(std::exchange(other.m_size, 0))
+				, m_capacity(std::exchange(other.m_capacity, 0))
+			{}
+
+			~value_vector(){
+				clear();
+				deallocate();
+			}
+
+			value_vector &operator=(const value_vector &other){
+				if(this != &other){
+					value_vector tmp(other);
+					*this = std::move(tmp);
+				}
+
+				return *this;
+			}
+
+			value_vector &operator=(value_vector &&other) noexcept{
+				if(this == &other) return *this;
+
+				clear();
+				deallocate();
+
+				this->reset_allocator(other.allocator());
+
+				m_type = other.m_type;
+				m_data = std::exchange(other.m_data, nullptr);
+				m_size = std::exchange(other.m_size, 0);
+				m_capacity = std::exchange(other.m_capacity, 0);
+
+				return *this;
+			}
+
+			/**
+			 * @brief Get the type of the contained values.
+			 */
+			type_info type() const noexcept{ return m_type; }
+
+			/**
+			 * @brief Get the distance in bytes between consecutive elements.
+			 */
+			std::size_t stride() const noexcept{ return m_type->size(); }
+
+			std::size_t size() const noexcept{ return m_size; }
+			std::size_t capacity() const noexcept{ return m_capacity; }
+			bool empty() const noexcept{ return m_size == 0; }
+
+			allocator_type get_allocator() const noexcept{ return this->allocator(); }
+
+			void *data() noexcept{ return m_data; }
+			const void *data() const noexcept{ return m_data; }
+
+			void *operator[](std::size_t idx) noexcept{ return m_data + (idx * stride()); }
+			const void *operator[](std::size_t idx) const noexcept{ return m_data + (idx * stride()); }
+
+			void *at(std::size_t idx){
+				if(idx >= m_size) throw std::out_of_range("value_vector index out of range");
+				return (*this)[idx];
+			}
+
+			const void *at(std::size_t idx) const{
+				if(idx >= m_size) throw std::out_of_range("value_vector index out of range");
+				return (*this)[idx];
+			}
+
+			/**
+			 * @brief Try to get the elements as an array of a specified type.
+			 * @returns pointer to the first element or `nullptr` if `T` is not the element type
+			 */
+			template<typename T>
+			T *data_as() noexcept{
+				return holds<T>() ? reinterpret_cast<T*>(m_data) : nullptr;
+			}
+
+			template<typename T>
+			const T *data_as() const noexcept{
+				return holds<T>() ? reinterpret_cast<const T*>(m_data) : nullptr;
+			}
+
+		#if __cplusplus >= 202002L
+			/**
+			 * @brief Try to get the elements as a span of a specified type.
+			 * @returns span of all elements or an empty span if `T` is not the element type
+			 */
+			template<typename T>
+			std::span<T> as_span() noexcept{
+				return holds<T>() ? std::span<T>(reinterpret_cast<T*>(m_data), m_size) : std::span<T>();
+			}
+
+			template<typename T>
+			std::span<const T> as_span() const noexcept{
+				return holds<T>() ? std::span<const T>(reinterpret_cast<const T*>(m_data), m_size) : std::span<const T>();
+			}
+		#endif
+
+			/**
+			 * @brief Check if the contained values are of a specified type.
+			 */
+			template<typename T>
+			bool holds() const noexcept{
+				return m_type->type_index() == std::type_index(typeid(T));
+			}
+
+			void reserve(std::size_t n){
+				if(n > m_capacity){
+					reallocate(n);
+				}
+			}
+
+			void shrink_to_fit(){
+				if(m_size < m_capacity){
+					reallocate(m_size);
+				}
+			}
+
+			/**
+			 * @brief Append `n` value-initialized elements.
+			 * @returns pointer to the first new element
+			 */
+			void *construct_n(std::size_t n){
+				grow(m_size + n);
+
+				void *first = (*this)[m_size];
+
+				if(!m_type->construct_n(first, n)){
+					throw std::runtime_error("Could not construct values");
+				}
+
+				m_size += n;
+				return first;
+			}
+
+			/**
+			 * @brief Destroy the last `n` elements.
+			 */
+			void destroy_n(std::size_t n) noexcept{
+				n = std::min(n, m_size);
+				m_size -= n;
+				m_type->destroy_n((*this)[m_size], n);
+			}
+
+			void resize(std::size_t n){
+				if(n > m_size){
+					construct_n(n - m_size);
+				}
+				else{
+					destroy_n(m_size - n);
+				}
+			}
+
+			void clear() noexcept{ destroy_n(m_size); }
+
+			/**
+			 * @brief Construct a new element at the end of the array.
+			 * @returns pointer to the new element
+			 */
+			template<typename ... Args>
+			void *emplace_back(Args &&... args){
+				auto pack = pack_args(std::forward<Args>(args)...);
+
+				return append([&](void *mem){
+					if(!m_type->construct(mem, &pack)){
+						throw std::runtime_error("Could not construct value");
+					}
+				});
+			}
+
+			/**
+			 * @brief Copy a value of the element type to the end of the array.
+			 * @returns pointer to the new element
+			 */
+			void *push_back(const void *val){
+				return append([&](void *mem){
+					if(!m_type->copy_construct(mem, val)){
+						throw std::runtime_error("Could not copy value");
+					}
+				});
+			}
+
+			void pop_back() noexcept{ destroy_n(1); }
+
+		private:
+			using alloc_base = detail::alloc_holder<allocator_type>;
+
+			void grow(std::size_t n){
+				if(n > m_capacity){
+					reallocate(std::max(n, m_capacity * 2));
+				}
+			}
+
+			/**
+			 * @brief Construct an element at the end with `construct(void *mem)`.
+			 * When the array grows, the element is constructed in the new buffer before the old elements are moved,
+			 * so it may be constructed from one of them like with `std::vector`.
+			 */
+			template<typename Construct>
+			void *append(Construct &&construct){
+				if(m_size < m_capacity){
+					void *mem = (*this)[m_size];
+					construct(mem);
+					++m_size;
+					return mem;
+				}
+
+				const std::size_t n = std::max(m_size + 1, m_capacity * 2);
+				auto mem = allocate_buffer(n);
+				void *elem = mem + (m_size * stride());
+
+				try{
+					construct(elem);
+				}
+				catch(...){
+					deallocate_buffer(mem, n);
+					throw;
+				}
+
+				try{
+					relocate_to(mem, n);
+				}
+				catch(...){
+					m_type->destroy(elem);
+					deallocate_buffer(mem, n);
+					throw;
+				}
+
+				++m_size;
+				return elem;
+			}
+
+			void reallocate(std::size_t n){
+				if(n == 0){
+					deallocate();
+					return;
+				}
+
+				auto mem = allocate_buffer(n);
+
+				try{
+					relocate_to(mem, n);
+				}
+				catch(...){
+					deallocate_buffer(mem, n);
+					throw;
+				}
+			}
+
+			/**
+			 * @brief Move the elements to `mem`, which holds `n` elements, and free the old buffer.
+			 */
+			void relocate_to(unsigned char *mem, std::size_t n){
+				if(m_size && !m_type->relocate_n(mem, m_data, m_size)){
+					throw std::runtime_error("Could not relocate values");
+				}
+
+				deallocate();
+
+				m_data = mem;
+				m_capacity = n;
+			}
+
+			unsigned char *allocate_buffer(std::size_t n){
+				return reinterpret_cast<unsigned char*>(detail::allocate_aligned(this->allocator(), n * stride(), m_type->alignment()));
+			}
+
+			void deallocate_buffer(unsigned char *mem, std::size_t n) noexcept{
+				detail::deallocate_aligned(this->allocator(), mem, n * stride(), m_type->alignment());
+			}
+
+			void deallocate() noexcept{
+				if(!m_data) return;
+				deallocate_buffer(m_data, m_capacity);
+				m_data = nullptr;
+				m_capacity = 0;
+			}
+
+			type_info m_type;
+			unsigned char *m_data = nullptr;
+			std::size_t m_size = 0, m_capacity = 0;
+	};
+
+	namespace pmr{
+		/**
+		 * @brief Value array that allocates from a `std::pmr::memory_resource`.
+		 */
+		using value_vector = reflpp::value_vector<std::pmr::polymorphic_allocator>;
+	}
+
+	/**
+	 * @brief Cache of freed value storage grouped by size and alignment class.
+	 * @note Pools are not thread-safe, use `object_pool::local()` to get a pool for the current thread.
+	 */
+	class object_pool{
+		public:
+			static constexpr std::size_t min_block_size = 16;
+			static constexpr std::size_t max_block_size = 64 * 1024;
+
+			/**
+			 * @param max_cached maximum number of free blocks kept per size class
+			 */
+			explicit object_pool(std::size_t max_cached = 256) noexcept;
+
+			object_pool(const object_pool&) = delete;
+
+			~object_pool();
+
+			object_pool &operator=(const object_pool&) = delete;
+
+			/**
+			 * @brief Get the pool for the current thread.
+			 * @warning Must not be called after the thread's pool was destroyed on thread exit, see `try_local`.
+			 */
+			static object_pool &local() noexcept;
+
+			/**
+			 * @brief Get the pool for the current thread if it is still alive.
+			 * @returns `nullptr` once the thread's pool was destroyed, e.g. from the destructor of a static or `thread_local` object
+			 */
+			static object_pool *try_local() noexcept;
+
+			/**
+			 * @brief Get uninitialized storage for a value of type `type`.
+			 */
+			void *allocate(type_info type);
+
+			/**
+			 * @brief Return storage previously allocated for `type` from any pool.
+			 */
+			void deallocate(void *p, type_info type) noexcept;
+
+			/**
+			 * @brief Free all cached blocks.
+			 */
+			void release() noexcept;
+
+			/**
+			 * @brief Number of allocations served from a free list.
+			 */
+			std::size_t hits() const noexcept{ return m_hits; }
+
+			/**
+			 * @brief Number of allocations that had to allocate a new block.
+			 */
+			std::size_t misses() const noexcept{ return m_misses; }
+
+			void reset_counters() noexcept{ m_hits = m_misses = 0; }
+
+		private:
+			static constexpr std::size_t num_size_classes = 13;
+			static constexpr std::size_t num_align_classes = 9;
+
+			/**
+			 * @brief Allocate a block the same way a pool does on a miss, without a pool.
+			 */
+			static void *allocate_block(type_info type);
+
+			/**
+			 * @brief Free a block from any pool without caching it.
+			 */
+			static void deallocate_block(void *p, type_info type) noexcept;
+
+			struct free_list{
+				void *head = nullptr;
+				std::size_t count = 0;
+			};
+
+			std::size_t m_max_cached;
+			std::size_t m_hits = 0, m_misses = 0;
+			free_list m_lists[num_size_classes][num_align_classes];
+
+			friend class pooled_value;
+	};
+
+	/**
+	 * @brief Owning handle to a value allocated from an `object_pool`.
+	 * @note Values created without an explicit pool return their storage to the pool of the destroying thread,
+	 * or straight to the global allocator if that pool was already destroyed.
+	 */
+	class pooled_value{
+		public:
+			pooled_value() = default;
+
+			template<typename ... Args>
+			explicit pooled_value(type_info type_, Args &&... args){
+				create(type_, std::forward<Args>(args)...);
+			}
+
+			template<typename ... Args>
+			pooled_value(object_pool &pool_, type_info type_, Args &&... args)
+				: m_pool(&pool_)
+			{
+				create(type_, std::forward<Args>(args)...);
+			}
+
+			pooled_value(const pooled_value&) = delete;
+
+			pooled_value(pooled_value &&other) noexcept
+				: m_type(std::exchange(other.m_type, nullptr))
+				, m_ptr(std::exchange(other.m_ptr, nullptr))
+				, m_pool(other.m_pool)
+			{}
+
+			~pooled_value(){ reset(); }
+
+			pooled_value &operator=(const pooled_value&) = delete;
+
+			pooled_value &operator=(pooled_value &&other) noexcept{
+				if(this != &other){
+					reset();
+					m_type = std::exchange(other.m_type, nullptr);
+					m_ptr = std::exchange(other.m_ptr, nullptr);
+					m_pool = other.m_pool;
+				}
+
+				return *this;
+			}
+
+			/**
+			 * @brief Destroy the contained value and return its storage to the pool.
+			 */
+			void reset() noexcept{
+				if(!m_type) return;
+
+				m_type->destroy(m_ptr);
+				deallocate(pool(), m_ptr, m_type);
+
+				m_type = nullptr;
+				m_ptr = nullptr;
+			}
+
+			bool is_valid() const noexcept{ return !!m_type; }
+
+			type_info type() const noexcept{ return m_type; }
+
+			void *get() noexcept{ return m_ptr; }
+			const void *get() const noexcept{ return m_ptr; }
+
+			/**
+			 * @brief Try to get the value as a specified type.
+			 */
+			template<typename T>
+			T *as() noexcept{
+				if(!is_valid()){
+					return nullptr;
+				}
+
+				if constexpr(std::is_class_v<T>){
+					auto cls = dynamic_cast<class_info>(m_type);
+					if(!cls) return nullptr;
+					return cls->template cast_to<T>(m_ptr);
+				}
+				else{
+					return m_type->type_index() == std::type_index(typeid(T)) ? reinterpret_cast<T*>(m_ptr) : nullptr;
+				}
+			}
+
+			template<typename T>
+			const T *as() const noexcept{
+				return const_cast<pooled_value*>(this)->template as<T>();
+			}
+
+		private:
+			object_pool *pool() const noexcept{ return m_pool ? m_pool : object_pool::try_local(); }
+
+			static void deallocate(object_pool *pool_, void *p, type_info type_) noexcept{
+				if(pool_){
+					pool_->deallocate(p, type_);
+				}
+				else{
+					object_pool::deallocate_block(p, type_);
+				}
+			}
+
+			template<typename ... Args>
+			void create(type_info type_, Args &&... args){
+				const auto pool_ = pool();
+				void *mem = pool_ ? pool_->allocate(type_) : object_pool::allocate_block(type_);
+				void *res = nullptr;
+
+				auto pack = pack_args(std::forward<Args>(args)...);
+
+				try{
+					res = type_->construct(mem, &pack);
+				}
+				catch(...){
+					deallocate(pool_, mem, type_);
+					throw;
+				}
+
+				if(!res){
+					deallocate(pool_, mem, type_);
+					throw std::runtime_error("Could not construct value");
+				}
+
+				m_ptr = mem;
+				m_type = type_;
+			}
+
+			type_info m_type = nullptr;
+			void *m_ptr = nullptr;
+			object_pool *m_pool = nullptr;
+	};
+}
+
+namespace std{
+	template<typename Base, template<typename> class AllocT, std::size_t SmallSize>
+	struct hash<reflpp::value<Base, AllocT, SmallSize>>{
+		std::size_t operator()(const reflpp::value<Base, AllocT, SmallSize> &val) const noexcept{ return val.hash(); }
+	};
 }
 
 #ifndef METACPP_NO_NAMESPACE_ALIAS
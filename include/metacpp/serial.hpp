@@ -17,52 +17,3089 @@
  */
 
 #include "meta.hpp"
+#include "refl.hpp"
 
-#include <sstream>
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define METACPP_SERIAL_SSE2 1
+#endif
+
+#ifdef _WIN32
+// without NOMINMAX windows.h defines min and max macros that break std::min and std::max,
+// both defines are only kept if the includer made them
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define METACPP_SERIAL_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define METACPP_SERIAL_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef METACPP_SERIAL_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef METACPP_SERIAL_LEAN_AND_MEAN
+#endif
+#ifdef METACPP_SERIAL_NOMINMAX
+#undef NOMINMAX
+#undef METACPP_SERIAL_NOMINMAX
+#endif
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace serialpp{
 	namespace detail{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		inline constexpr bool is_little_endian = false;
+#else
+		inline constexpr bool is_little_endian = true;
+#endif
+
+		class binary_writer{
+			public:
+				binary_writer(void *out, std::size_t size) noexcept
+					: m_begin(static_cast<unsigned char*>(out)), m_it(m_begin), m_end(m_begin + size){}
+
+				bool write(const void *data, std::size_t n) noexcept{
+					if(std::size_t(m_end - m_it) < n) return false;
+					if(n) std::memcpy(m_it, data, n);
+					m_it += n;
+					return true;
+				}
+
+				std::size_t size() const noexcept{ return m_it - m_begin; }
+
+			private:
+				unsigned char *m_begin, *m_it, *m_end;
+		};
+
+		// same interface as binary_writer, for measuring an encoding without writing it
+		class binary_counter{
+			public:
+				bool write(const void*, std::size_t n) noexcept{
+					m_size += n;
+					return true;
+				}
+
+				std::size_t size() const noexcept{ return m_size; }
+
+			private:
+				std::size_t m_size = 0;
+		};
+
+		class binary_reader{
+			public:
+				binary_reader(const void *data, std::size_t size) noexcept
+					: m_begin(static_cast<const unsigned char*>(data)), m_it(m_begin), m_end(m_begin + size){}
+
+				bool read(void *out, std::size_t n) noexcept{
+					if(remaining() < n) return false;
+					if(n) std::memcpy(out, m_it, n);
+					m_it += n;
+					return true;
+				}
+
+				bool skip(std::size_t n) noexcept{
+					if(remaining() < n) return false;
+					m_it += n;
+					return true;
+				}
+
+				std::size_t remaining() const noexcept{ return m_end - m_it; }
+				std::size_t size() const noexcept{ return m_it - m_begin; }
+
+			private:
+				const unsigned char *m_begin, *m_it, *m_end;
+		};
+
+		template<typename Writer>
+		bool write_varint(Writer &w, std::uint64_t val){
+			unsigned char bytes[10];
+			std::size_t n = 0;
+
+			do{
+				bytes[n] = val & 0x7f;
+				val >>= 7;
+				bytes[n++] |= val ? 0x80 : 0;
+			} while(val);
+
+			return w.write(bytes, n);
+		}
+
+		inline bool read_varint(binary_reader &r, std::uint64_t &val){
+			val = 0;
+
+			for(unsigned shift = 0; shift < 64; shift += 7){
+				unsigned char byte;
+				if(!r.read(&byte, 1)) return false;
+
+				val |= std::uint64_t(byte & 0x7f) << shift;
+				if(!(byte & 0x80)) return true;
+			}
+
+			return false;
+		}
+
+		template<typename Writer>
+		bool write_uint(Writer &w, std::uint64_t val, std::size_t n){
+			unsigned char bytes[8];
+			for(std::size_t i = 0; i < n; i++){
+				bytes[i] = static_cast<unsigned char>(val >> (i * 8));
+			}
+			return w.write(bytes, n);
+		}
+
+		inline bool read_uint(binary_reader &r, std::uint64_t &val, std::size_t n){
+			unsigned char bytes[8];
+			if(!r.read(bytes, n)) return false;
+
+			val = 0;
+			for(std::size_t i = 0; i < n; i++){
+				val |= std::uint64_t(bytes[i]) << (i * 8);
+			}
+
+			return true;
+		}
+
+		template<typename T, typename = void>
+		struct binary_codec{
+			static_assert(!std::is_same_v<T, T>, "type has no binary encoding");
+		};
+
+		// types whose encoding is their object representation, so ranges of them can be copied in one go
+		template<typename T, typename = void>
+		struct is_raw: std::bool_constant<
+			((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>) &&
+			(is_little_endian || sizeof(T) == 1)
+		>{};
+
+		template<typename T, std::size_t N>
+		struct is_raw<std::array<T, N>>: is_raw<T>{};
+
+		template<typename Writer, typename = void>
+		struct can_write_in_place: std::false_type{};
+
+		template<typename Writer>
+		struct can_write_in_place<Writer, std::void_t<decltype(std::declval<Writer&>().write_in_place(nullptr, 0))>>: std::true_type{};
+
+		// bytes that live inside the value being written, writers may reference them instead of copying
+		template<typename Writer>
+		bool write_in_place(Writer &w, const void *data, std::size_t n){
+			if constexpr(can_write_in_place<Writer>::value){
+				return w.write_in_place(data, n);
+			}
+			else{
+				return w.write(data, n);
+			}
+		}
+
+		template<typename T, typename Writer>
+		bool write_range(Writer &w, const T *data, std::size_t n){
+			if constexpr(is_raw<T>::value){
+				return write_in_place(w, data, n * sizeof(T));
+			}
+			else{
+				for(std::size_t i = 0; i < n; i++){
+					if(!binary_codec<T>::write(data[i], w)) return false;
+				}
+
+				return true;
+			}
+		}
+
+		template<typename T>
+		bool read_range(binary_reader &r, T *data, std::size_t n){
+			if constexpr(is_raw<T>::value){
+				return r.read(data, n * sizeof(T));
+			}
+			else{
+				for(std::size_t i = 0; i < n; i++){
+					if(!binary_codec<T>::read(data[i], r)) return false;
+				}
+
+				return true;
+			}
+		}
+
+		template<typename T>
+		struct binary_codec<T, std::enable_if_t<std::is_arithmetic_v<T>>>{
+			static_assert(!std::is_same_v<T, long double>, "long double has no portable binary encoding");
+
+			template<typename Writer>
+			static bool write(const T &val, Writer &w){
+				if constexpr(std::is_same_v<T, bool>){
+					const unsigned char byte = val;
+					return w.write(&byte, 1);
+				}
+				else if constexpr(is_raw<T>::value){
+					return w.write(&val, sizeof(T));
+				}
+				else{
+					unsigned char bytes[sizeof(T)];
+					std::memcpy(bytes, &val, sizeof(T));
+					std::reverse(bytes, bytes + sizeof(T));
+					return w.write(bytes, sizeof(T));
+				}
+			}
+
+			static bool read(T &val, binary_reader &r){
+				if constexpr(std::is_same_v<T, bool>){
+					unsigned char byte;
+					if(!r.read(&byte, 1) || byte > 1) return false;
+					val = byte;
+					return true;
+				}
+				else if constexpr(is_raw<T>::value){
+					return r.read(&val, sizeof(T));
+				}
+				else{
+					unsigned char bytes[sizeof(T)];
+					if(!r.read(bytes, sizeof(T))) return false;
+					std::reverse(bytes, bytes + sizeof(T));
+					std::memcpy(&val, bytes, sizeof(T));
+					return true;
+				}
+			}
+		};
+
+		template<typename Values>
+		struct enum_value_bits;
+
+		template<typename ... Values>
+		struct enum_value_bits<metapp::types<Values...>>{
+			static constexpr std::uint64_t value = (std::uint64_t(0) | ... | Values::value);
+		};
+
+		// enums are written with the fewest bytes that hold every enumerator
+		template<typename Enum>
+		constexpr std::size_t enum_wire_size() noexcept{
+			if constexpr(metapp::has_enum_info<Enum>){
+				constexpr auto bits = enum_value_bits<metapp::enum_values<Enum>>::value;
+				constexpr std::size_t size = bits <= 0xff ? 1 : bits <= 0xffff ? 2 : bits <= 0xffffffff ? 4 : 8;
+				return std::min(size, sizeof(Enum));
+			}
+			else{
+				return sizeof(Enum);
+			}
+		}
+
+		template<typename Enum>
+		struct binary_codec<Enum, std::enable_if_t<std::is_enum_v<Enum>>>{
+			using underlying = std::underlying_type_t<Enum>;
+			using unsigned_type = std::make_unsigned_t<underlying>;
+
+			static constexpr std::size_t size = enum_wire_size<Enum>();
+
+			template<typename Writer>
+			static bool write(const Enum &val, Writer &w){
+				const std::uint64_t bits = static_cast<unsigned_type>(static_cast<underlying>(val));
+
+				if constexpr(size < 8){
+					if(bits >> (size * 8)) return false;
+				}
+
+				return write_uint(w, bits, size);
+			}
+
+			static bool read(Enum &val, binary_reader &r){
+				std::uint64_t bits;
+				if(!read_uint(r, bits, size)) return false;
+				val = static_cast<Enum>(static_cast<underlying>(static_cast<unsigned_type>(bits)));
+				return true;
+			}
+		};
+
+		// fewest bytes the encoding of a type takes, only types that always encode to nothing give `0`
 		template<typename T, typename = void>
-		struct to_json_helper;
+		struct binary_min_size: std::integral_constant<std::size_t, 1>{};
+
+		template<typename T>
+		struct binary_min_size<T, std::enable_if_t<std::is_arithmetic_v<T>>>: std::integral_constant<std::size_t, std::is_same_v<T, bool> ? 1 : sizeof(T)>{};
+
+		template<typename Enum>
+		struct binary_min_size<Enum, std::enable_if_t<std::is_enum_v<Enum>>>: std::integral_constant<std::size_t, enum_wire_size<Enum>()>{};
+
+		template<typename T, std::size_t N>
+		struct binary_min_size<std::array<T, N>>: std::integral_constant<std::size_t, N * binary_min_size<T>::value>{};
+
+		template<typename Char, typename Traits, typename Alloc>
+		struct binary_codec<std::basic_string<Char, Traits, Alloc>>{
+			using string_type = std::basic_string<Char, Traits, Alloc>;
+
+			template<typename Writer>
+			static bool write(const string_type &val, Writer &w){
+				return write_varint(w, val.size()) && write_range(w, val.data(), val.size());
+			}
+
+			static bool read(string_type &val, binary_reader &r){
+				std::uint64_t n;
+				if(!read_varint(r, n) || n > r.remaining() / sizeof(Char)) return false;
+				val.resize(n);
+				return read_range(r, val.data(), n);
+			}
+		};
+
+		template<typename T, typename Alloc>
+		struct binary_codec<std::vector<T, Alloc>, std::enable_if_t<!std::is_same_v<T, bool>>>{
+			// the length read is bounded by the input left, which elements that encode to nothing don't consume
+			static_assert(binary_min_size<T>::value > 0, "vector elements must encode to at least one byte");
+
+			template<typename Writer>
+			static bool write(const std::vector<T, Alloc> &val, Writer &w){
+				return write_varint(w, val.size()) && write_range(w, val.data(), val.size());
+			}
+
+			static bool read(std::vector<T, Alloc> &val, binary_reader &r){
+				std::uint64_t n;
+				if(!read_varint(r, n) || n > r.remaining() / binary_min_size<T>::value) return false;
+
+				if constexpr(is_raw<T>::value){
+					val.resize(n);
+					return read_range(r, val.data(), n);
+				}
+				else{
+					val.clear();
+					val.reserve(n);
 
+					for(std::uint64_t i = 0; i < n; i++){
+						if(!binary_codec<T>::read(val.emplace_back(), r)) return false;
+					}
+
+					return true;
+				}
+			}
+		};
+
+		template<typename T, std::size_t N>
+		struct binary_codec<std::array<T, N>>{
+			template<typename Writer>
+			static bool write(const std::array<T, N> &val, Writer &w){
+				return write_range(w, val.data(), N);
+			}
+
+			static bool read(std::array<T, N> &val, binary_reader &r){
+				return read_range(r, val.data(), N);
+			}
+		};
+
+		template<typename T>
+		struct binary_codec<std::optional<T>>{
+			template<typename Writer>
+			static bool write(const std::optional<T> &val, Writer &w){
+				const unsigned char has_value = val.has_value();
+				return w.write(&has_value, 1) && (!has_value || binary_codec<T>::write(*val, w));
+			}
+
+			static bool read(std::optional<T> &val, binary_reader &r){
+				unsigned char has_value;
+				if(!r.read(&has_value, 1) || has_value > 1) return false;
+
+				if(!has_value){
+					val.reset();
+					return true;
+				}
+
+				return binary_codec<T>::read(val.emplace(), r);
+			}
+		};
+
+		/**
+		 * @brief Public bases of a class that hold data, with variadic bases expanded.
+		 * Their encoding comes before the members of the class, non-public bases are skipped like inaccessible members.
+		 */
 		template<typename Class>
-		struct to_json_helper<Class, std::enable_if_t<std::is_class_v<Class>>>{
-			static std::string invoke(const Class &cls){
-				std::ostringstream output;
-				output << std::noshowpoint;
-
-				output << "{\"" << metapp::type_name<Class> << "\":[";
-
-				metapp::for_all_i<metapp::members<Class>>(
-					[&]<class Member, std::size_t Idx>{
-						constexpr std::string_view name = Member::name;
-						constexpr std::string_view type_name = meta::type_name<typename Member::type>;
-						const auto &val = Member::get(cls);
-						if constexpr(Idx != 0){
-							output << ",";
-						}
-						output << "{\"member\":{";
-						output << "\"name\":\"";
-						output << name;
-						output << "\",\"type\":\"";
-						output << type_name;
-						output << "\",\"value\":\"";
-						output << val;
-						output << "\"}}";
+		using encoded_bases = metapp::data_bases<Class>;
+
+		template<typename Member>
+		constexpr bool is_raw_member() noexcept{
+			return Member::is_accessable && Member::offset != metapp::detail::unknown_offset && is_raw<typename Member::type>::value;
+		}
+
+		/**
+		 * @brief Members of a class grouped into runs of padding-free raw members, each copied with a single `memcpy`.
+		 */
+		template<typename Class, typename Members = metapp::members<Class>>
+		struct binary_layout;
+
+		template<typename Class, typename ... Members>
+		struct binary_layout<Class, metapp::types<Members...>>{
+			static constexpr std::size_t num_members = sizeof...(Members);
+
+			static constexpr bool raw[] = { is_raw_member<Members>()..., false };
+			static constexpr std::size_t offsets[] = { Members::offset..., 0 };
+			static constexpr std::size_t sizes[] = { sizeof(typename Members::type)..., 0 };
+
+			struct runs_t{
+				// bytes in the run starting at each member, `0` if no run starts there
+				std::size_t bytes[num_members + 1];
+				// whether a member is copied by an earlier member's run
+				bool covered[num_members + 1];
+			};
+
+			static constexpr runs_t make_runs() noexcept{
+				runs_t ret{};
+				std::size_t start = 0;
+
+				for(std::size_t i = 0; i < num_members; i++){
+					if(!raw[i]) continue;
+
+					if(i > 0 && raw[i - 1] && offsets[i - 1] + sizes[i - 1] == offsets[i]){
+						ret.covered[i] = true;
+						ret.bytes[start] += sizes[i];
 					}
-				);
+					else{
+						start = i;
+						ret.bytes[i] = sizes[i];
+					}
+				}
+
+				return ret;
+			}
+
+			static constexpr runs_t runs = make_runs();
+
+			// a single run covering the whole class means the encoding is the object representation
+			static constexpr bool is_raw =
+				std::is_trivially_copyable_v<Class> &&
+				metapp::bases<Class>::size == 0 &&
+				num_members > 0 && offsets[0] == 0 && runs.bytes[0] == sizeof(Class);
+
+			template<std::size_t I, typename Writer>
+			static bool write_member(const Class &cls, Writer &w){
+				using member = metapp::get_t<metapp::types<Members...>, I>;
 
-				output << "]}";
+				if constexpr(!member::is_accessable || runs.covered[I]){
+					return true;
+				}
+				else if constexpr(runs.bytes[I] != 0){
+					return write_in_place(w, reinterpret_cast<const unsigned char*>(std::addressof(cls)) + offsets[I], runs.bytes[I]);
+				}
+				else{
+					return binary_codec<typename member::type>::write(member::get(cls), w);
+				}
+			}
+
+			template<std::size_t I>
+			static bool read_member(Class &cls, binary_reader &r){
+				using member = metapp::get_t<metapp::types<Members...>, I>;
+
+				if constexpr(!member::is_accessable || runs.covered[I]){
+					return true;
+				}
+				else if constexpr(runs.bytes[I] != 0){
+					return r.read(reinterpret_cast<unsigned char*>(std::addressof(cls)) + offsets[I], runs.bytes[I]);
+				}
+				else{
+					return binary_codec<typename member::type>::read(member::get(cls), r);
+				}
+			}
+
+			template<typename Writer, std::size_t ... Is>
+			static bool write(const Class &cls, Writer &w, std::index_sequence<Is...>){
+				return (write_member<Is>(cls, w) && ...);
+			}
+
+			template<std::size_t ... Is>
+			static bool read(Class &cls, binary_reader &r, std::index_sequence<Is...>){
+				return (read_member<Is>(cls, r) && ...);
+			}
+		};
+
+		template<typename Class>
+		struct is_raw<Class, std::enable_if_t<metapp::has_info<Class>>>: std::bool_constant<binary_layout<Class>::is_raw>{};
+
+		template<typename Class, typename Bases = encoded_bases<Class>>
+		struct class_codec;
 
-				return output.str();
+		template<typename Class, typename ... Bases>
+		struct class_codec<Class, metapp::types<Bases...>>{
+			using layout = binary_layout<Class>;
+
+			template<typename Writer>
+			static bool write(const Class &val, Writer &w){
+				return
+					(binary_codec<Bases>::write(static_cast<const Bases&>(val), w) && ...) &&
+					layout::write(val, w, std::make_index_sequence<layout::num_members>());
+			}
+
+			static bool read(Class &val, binary_reader &r){
+				return
+					(binary_codec<Bases>::read(static_cast<Bases&>(val), r) && ...) &&
+					layout::read(val, r, std::make_index_sequence<layout::num_members>());
 			}
 		};
+
+		template<typename Class>
+		struct binary_codec<Class, std::enable_if_t<metapp::has_info<Class>>>: class_codec<Class>{};
+
+		template<typename Member>
+		constexpr std::size_t member_min_size() noexcept{
+			if constexpr(Member::is_accessable) return binary_min_size<typename Member::type>::value;
+			else return 0;
+		}
+
+		template<typename Class, typename Members = metapp::members<Class>, typename Bases = encoded_bases<Class>>
+		struct class_min_size;
+
+		template<typename Class, typename ... Members, typename ... Bases>
+		struct class_min_size<Class, metapp::types<Members...>, metapp::types<Bases...>>: std::integral_constant<
+			std::size_t, (std::size_t(0) + ... + binary_min_size<Bases>::value) + (std::size_t(0) + ... + member_min_size<Members>())
+		>{};
+
+		template<typename Class>
+		struct binary_min_size<Class, std::enable_if_t<metapp::has_info<Class>>>: class_min_size<Class>{};
+	}
+
+	/**
+	 * @brief Get the number of bytes `to_binary` writes for a value.
+	 */
+	template<typename T>
+	std::size_t binary_size(const T &val){
+		detail::binary_counter counter;
+		detail::binary_codec<T>::write(val, counter);
+		return counter.size();
+	}
+
+	/**
+	 * @brief Encode a value into a caller supplied buffer.
+	 *
+	 * Arithmetic values are written little-endian at their native width, enums at the width of their
+	 * largest enumerator and string and vector lengths as varints. Reflected classes write their public
+	 * bases, then their accessible members in order, copying runs of padding-free trivially copyable members at once.
+	 *
+	 * @returns number of bytes written, `std::nullopt` if `size` is too small or the value can't be encoded
+	 */
+	template<typename T>
+	std::optional<std::size_t> to_binary(const T &val, void *out, std::size_t size){
+		detail::binary_writer writer(out, size);
+		if(!detail::binary_codec<T>::write(val, writer)) return std::nullopt;
+		return writer.size();
 	}
 
+	/**
+	 * @brief Decode a value written by `to_binary`.
+	 * @returns number of bytes read, `std::nullopt` if the data is truncated or malformed
+	 */
 	template<typename T>
-	std::string to_json(const T &val){
-		return detail::to_json_helper<T>::invoke(val);
+	std::optional<std::size_t> from_binary(const void *data, std::size_t size, T &out){
+		detail::binary_reader reader(data, size);
+		if(!detail::binary_codec<T>::read(out, reader)) return std::nullopt;
+		return reader.size();
+	}
+
+	/**
+	 * @brief Collects the `to_binary` encoding of values as a list of segments for scatter-gather output.
+	 *
+	 * Small fields are packed into scratch memory owned by the sink. Contiguous runs of at least
+	 * `reference_threshold` bytes inside a value, such as the data of large strings and vectors of
+	 * trivially copyable elements, are referenced in place instead of copied, so written values
+	 * must outlive the next `flush` or `clear`.
+	 */
+	class gather_sink{
+		public:
+			struct segment{
+				const unsigned char *data;
+				std::size_t size;
+			};
+
+			explicit gather_sink(std::size_t reference_threshold = 4096) noexcept
+				: m_threshold(std::max<std::size_t>(reference_threshold, 1)){}
+
+			gather_sink(gather_sink&&) noexcept = default;
+			gather_sink &operator=(gather_sink&&) noexcept = default;
+
+			/**
+			 * @brief Append the encoding of a value.
+			 * @returns whether the value could be encoded, the sink is left unchanged if not
+			 */
+			template<typename T>
+			bool write(const T &val){
+				const auto state = save();
+				if(detail::binary_codec<T>::write(val, *this)) return true;
+
+				restore(state);
+				return false;
+			}
+
+			// writer interface used by the codecs
+
+			bool write(const void *data, std::size_t n){
+				if(n == 0) return true;
+
+				if(m_chunks.empty() || chunk_size - m_chunk_used < n){
+					m_chunks.emplace_back(new unsigned char[std::max(chunk_size, n)]);
+					m_chunk_used = 0;
+				}
+
+				auto dst = m_chunks.back().get() + m_chunk_used;
+				std::memcpy(dst, data, n);
+				m_chunk_used += n;
+
+				push(dst, n);
+				return true;
+			}
+
+			bool write_in_place(const void *data, std::size_t n){
+				if(n < m_threshold) return write(data, n);
+
+				push(static_cast<const unsigned char*>(data), n);
+				return true;
+			}
+
+			/**
+			 * @brief Get the segments not yet flushed.
+			 */
+			const std::vector<segment> &segments() const noexcept{ return m_segments; }
+
+			/**
+			 * @brief Get the number of bytes not yet flushed.
+			 */
+			std::size_t size() const noexcept{ return m_size; }
+
+			void clear() noexcept{
+				m_segments.clear();
+				m_chunks.clear();
+				m_chunk_used = 0;
+				m_size = 0;
+			}
+
+		#ifndef _WIN32
+			/**
+			 * @brief Write every pending segment to a file or socket with `writev`.
+			 *
+			 * Partial writes are resumed and interrupted calls retried. On failure, including `EAGAIN`
+			 * from non-blocking descriptors, the segments not yet written are kept for the next flush.
+			 *
+			 * @returns whether everything was written, `errno` holds the reason if not
+			 */
+			bool flush(int fd){
+			#ifdef IOV_MAX
+				constexpr std::size_t max_iov = IOV_MAX;
+			#else
+				constexpr std::size_t max_iov = 1024;
+			#endif
+
+				iovec iov[std::min<std::size_t>(max_iov, 64)];
+				std::size_t first = 0;
+
+				while(first < m_segments.size()){
+					const auto count = std::min(std::size(iov), m_segments.size() - first);
+
+					for(std::size_t i = 0; i < count; i++){
+						iov[i].iov_base = const_cast<unsigned char*>(m_segments[first + i].data);
+						iov[i].iov_len = m_segments[first + i].size;
+					}
+
+					const auto written = ::writev(fd, iov, static_cast<int>(count));
+
+					if(written < 0){
+						if(errno == EINTR) continue;
+
+						m_segments.erase(m_segments.begin(), m_segments.begin() + first);
+						return false;
+					}
+
+					auto remaining = static_cast<std::size_t>(written);
+					m_size -= remaining;
+
+					while(remaining && remaining >= m_segments[first].size){
+						remaining -= m_segments[first++].size;
+					}
+
+					if(remaining){
+						m_segments[first].data += remaining;
+						m_segments[first].size -= remaining;
+					}
+				}
+
+				clear();
+				return true;
+			}
+		#endif
+
+		private:
+			static constexpr std::size_t chunk_size = 4096;
+
+			struct state{
+				std::size_t num_segments, last_size, num_chunks, chunk_used, size;
+			};
+
+			state save() const noexcept{
+				return { m_segments.size(), m_segments.empty() ? 0 : m_segments.back().size, m_chunks.size(), m_chunk_used, m_size };
+			}
+
+			void restore(const state &s) noexcept{
+				m_segments.resize(s.num_segments);
+				if(!m_segments.empty()) m_segments.back().size = s.last_size;
+				m_chunks.resize(s.num_chunks);
+				m_chunk_used = s.chunk_used;
+				m_size = s.size;
+			}
+
+			// adjacent bytes extend the last segment
+			void push(const unsigned char *data, std::size_t n){
+				if(!m_segments.empty()){
+					auto &&last = m_segments.back();
+					if(last.data + last.size == data){
+						last.size += n;
+						m_size += n;
+						return;
+					}
+				}
+
+				m_segments.push_back({ data, n });
+				m_size += n;
+			}
+
+			std::size_t m_threshold;
+			std::vector<segment> m_segments;
+			std::vector<std::unique_ptr<unsigned char[]>> m_chunks;
+			std::size_t m_chunk_used = 0, m_size = 0;
+	};
+
+	/**
+	 * @brief Binary serialization plan for a class only known at runtime through `refl::class_info`.
+	 *
+	 * The members of the class, with nested classes inlined, are compiled once into a flat list of
+	 * operations on byte offsets. Plans write the same encoding as `to_binary`.
+	 */
+	class plan{
+		public:
+			enum class op_kind: std::uint8_t{
+				copy, ///< copy `size` bytes, a run of little-endian scalars
+				swap, ///< scalar of `size` bytes written in reverse byte order
+				enum_, ///< enum of `size` bytes written in `wire_size` bytes
+				bool_, ///< `bool`, rejected when read unless 0 or 1
+				string ///< `std::string`
+			};
+
+			struct op{
+				op_kind kind;
+				std::size_t offset, size, wire_size;
+			};
+
+			/**
+			 * @brief Get the plan for a class, compiling it on first use.
+			 * @returns `nullptr` if a member of the class has no encoding known at runtime or a base has members
+			 */
+			static const plan *get(refl::class_info cls){
+				static std::shared_mutex mut;
+				static std::unordered_map<refl::class_info, std::unique_ptr<plan>> plans;
+				// plans replaced after their type was unloaded may still be in use
+				static std::vector<std::unique_ptr<plan>> retired;
+
+				if(!cls) return nullptr;
+
+				const auto is_current = [cls](const plan &p){
+					return p.m_id == cls->id() && p.m_fingerprint == cls->layout_fingerprint();
+				};
+
+				// classes that can't be planned are kept too, so they aren't compiled again on every call
+				const auto result = [](const plan &p){ return p.m_plannable ? &p : nullptr; };
+
+				{
+					std::shared_lock lock(mut);
+					auto res = plans.find(cls);
+					if(res != plans.end() && is_current(*res->second)){
+						return result(*res->second);
+					}
+				}
+
+				auto compiled = std::make_unique<plan>(cls);
+				compiled->m_plannable = compile(cls, 0, compiled->m_ops);
+				if(!compiled->m_plannable) compiled->m_ops.clear();
+
+				std::unique_lock lock(mut);
+
+				auto &&entry = plans[cls];
+				if(entry && is_current(*entry)){
+					return result(*entry);
+				}
+				else if(entry){
+					retired.emplace_back(std::move(entry));
+				}
+
+				entry = std::move(compiled);
+				return result(*entry);
+			}
+
+			explicit plan(refl::class_info cls) noexcept
+				: m_type(cls), m_id(cls->id()), m_fingerprint(cls->layout_fingerprint()){}
+
+			refl::class_info type() const noexcept{ return m_type; }
+
+			const std::vector<op> &ops() const noexcept{ return m_ops; }
+
+			/**
+			 * @brief Get the number of bytes `to_binary` writes for an object.
+			 */
+			std::size_t binary_size(const void *obj) const{
+				detail::binary_counter counter;
+				write(obj, counter);
+				return counter.size();
+			}
+
+			/**
+			 * @brief Encode an object of the planned class.
+			 * @see serialpp::to_binary
+			 */
+			std::optional<std::size_t> to_binary(const void *obj, void *out, std::size_t size) const{
+				detail::binary_writer writer(out, size);
+				if(!write(obj, writer)) return std::nullopt;
+				return writer.size();
+			}
+
+			/**
+			 * @brief Decode into an existing object of the planned class.
+			 * @see serialpp::from_binary
+			 */
+			std::optional<std::size_t> from_binary(const void *data, std::size_t size, void *obj) const{
+				detail::binary_reader reader(data, size);
+				if(!read(reader, obj)) return std::nullopt;
+				return reader.size();
+			}
+
+		private:
+			static std::uint64_t load_uint(const unsigned char *p, std::size_t size) noexcept{
+				switch(size){
+					case 1: return *p;
+					case 2:{ std::uint16_t v; std::memcpy(&v, p, 2); return v; }
+					case 4:{ std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+					default:{ std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+				}
+			}
+
+			static void store_uint(unsigned char *p, std::size_t size, std::uint64_t val) noexcept{
+				switch(size){
+					case 1: *p = static_cast<unsigned char>(val); break;
+					case 2:{ const auto v = static_cast<std::uint16_t>(val); std::memcpy(p, &v, 2); break; }
+					case 4:{ const auto v = static_cast<std::uint32_t>(val); std::memcpy(p, &v, 4); break; }
+					default: std::memcpy(p, &val, 8); break;
+				}
+			}
+
+			static void add_copy(std::vector<op> &ops, std::size_t offset, std::size_t size){
+				if(!ops.empty() && ops.back().kind == op_kind::copy && ops.back().offset + ops.back().size == offset){
+					ops.back().size += size;
+					ops.back().wire_size += size;
+				}
+				else{
+					ops.push_back({ op_kind::copy, offset, size, size });
+				}
+			}
+
+			static bool compile(refl::class_info cls, std::size_t base, std::vector<op> &ops){
+				// the offsets of bases aren't known at runtime, so only bases without members can be planned
+				for(std::size_t i = 0; i < cls->num_bases(); i++){
+					auto base_cls = cls->base(i);
+					if(!base_cls || base_cls->num_members() != 0 || base_cls->num_bases() != 0) return false;
+				}
+
+				for(std::size_t i = 0; i < cls->num_members(); i++){
+					auto member = cls->member(i);
+
+					const auto offset = member->offset();
+					if(offset == std::size_t(-1)){
+						// members of standard layout classes only lack an offset when they are inaccessible
+						if(member->is_standard_layout()) continue;
+						return false;
+					}
+
+					auto type = member->type();
+					if(!type) return false;
+
+					const auto at = base + offset;
+					const auto size = type->size();
+
+					if(auto num = dynamic_cast<refl::num_info>(type)){
+						if(num->is_floating_point() && size > 8) return false;
+
+						if(type->id() == metapp::type_id<bool>){
+							// any other byte read into a bool is undefined, so bools can't join copy runs
+							ops.push_back({ op_kind::bool_, at, size, size });
+						}
+						else if(detail::is_little_endian || size == 1){
+							add_copy(ops, at, size);
+						}
+						else{
+							ops.push_back({ op_kind::swap, at, size, size });
+						}
+					}
+					else if(auto enm = dynamic_cast<refl::enum_info>(type)){
+						std::uint64_t bits = 0;
+						for(std::size_t j = 0; j < enm->num_values(); j++){
+							bits |= enm->value(j)->value();
+						}
+
+						const std::size_t wire_size = bits <= 0xff ? 1 : bits <= 0xffff ? 2 : bits <= 0xffffffff ? 4 : 8;
+						ops.push_back({ op_kind::enum_, at, size, std::min(wire_size, size) });
+					}
+					else if(type->id() == metapp::type_id<std::string>){
+						ops.push_back({ op_kind::string, at, size, 0 });
+					}
+					else if(auto nested = dynamic_cast<refl::class_info>(type); nested && nested->layout_fingerprint()){
+						if(!compile(nested, at, ops)) return false;
+					}
+					else{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			template<typename Writer>
+			bool write(const void *obj, Writer &w) const{
+				const auto base = static_cast<const unsigned char*>(obj);
+
+				for(auto &&op : m_ops){
+					const auto p = base + op.offset;
+
+					switch(op.kind){
+						case op_kind::copy:{
+							if(!w.write(p, op.size)) return false;
+							break;
+						}
+
+						case op_kind::swap:{
+							unsigned char bytes[8];
+							std::reverse_copy(p, p + op.size, bytes);
+							if(!w.write(bytes, op.size)) return false;
+							break;
+						}
+
+						case op_kind::enum_:{
+							const auto bits = load_uint(p, op.size);
+							if((op.wire_size < 8 && (bits >> (op.wire_size * 8))) || !detail::write_uint(w, bits, op.wire_size)) return false;
+							break;
+						}
+
+						case op_kind::bool_:{
+							if(!w.write(p, 1)) return false;
+							break;
+						}
+
+						case op_kind::string:{
+							auto &&str = *reinterpret_cast<const std::string*>(p);
+							if(!detail::write_varint(w, str.size()) || !w.write(str.data(), str.size())) return false;
+							break;
+						}
+					}
+				}
+
+				return true;
+			}
+
+			bool read(detail::binary_reader &r, void *obj) const{
+				const auto base = static_cast<unsigned char*>(obj);
+
+				for(auto &&op : m_ops){
+					const auto p = base + op.offset;
+
+					switch(op.kind){
+						case op_kind::copy:{
+							if(!r.read(p, op.size)) return false;
+							break;
+						}
+
+						case op_kind::swap:{
+							if(!r.read(p, op.size)) return false;
+							std::reverse(p, p + op.size);
+							break;
+						}
+
+						case op_kind::enum_:{
+							std::uint64_t bits;
+							if(!detail::read_uint(r, bits, op.wire_size)) return false;
+							store_uint(p, op.size, bits);
+							break;
+						}
+
+						case op_kind::bool_:{
+							unsigned char byte;
+							if(!r.read(&byte, 1) || byte > 1) return false;
+							*reinterpret_cast<bool*>(p) = byte;
+							break;
+						}
+
+						case op_kind::string:{
+							auto &&str = *reinterpret_cast<std::string*>(p);
+
+							std::uint64_t n;
+							if(!detail::read_varint(r, n) || n > r.remaining()) return false;
+
+							str.resize(n);
+							if(!r.read(str.data(), n)) return false;
+							break;
+						}
+					}
+				}
+
+				return true;
+			}
+
+			refl::class_info m_type;
+			std::uint64_t m_id, m_fingerprint;
+			std::vector<op> m_ops;
+			bool m_plannable = false;
+	};
+
+	namespace detail{
+		// same interface as binary_writer, appending to a growing buffer
+		class binary_appender{
+			public:
+				explicit binary_appender(std::vector<unsigned char> &out) noexcept: m_out(out){}
+
+				bool write(const void *data, std::size_t n){
+					auto bytes = static_cast<const unsigned char*>(data);
+					m_out.insert(m_out.end(), bytes, bytes + n);
+					return true;
+				}
+
+				std::size_t size() const noexcept{ return m_out.size(); }
+
+			private:
+				std::vector<unsigned char> &m_out;
+		};
+
+		enum class schema_code: std::uint8_t{
+			bool_ = 1, int_, uint_, float_, enum_, string, vector, array, optional, class_
+		};
+
+		struct schema_field;
+
+		/**
+		 * @brief Parsed description of how a value was encoded by a stream writer.
+		 */
+		struct schema_node{
+			schema_code code;
+			std::uint8_t width = 0; // bytes of scalars and enums, bytes per character of strings
+			std::uint64_t count = 0; // elements of arrays
+			std::vector<schema_node> element; // element of vectors, arrays and optionals
+			std::vector<schema_field> fields; // members of classes
+		};
+
+		struct schema_field{
+			std::uint32_t id;
+			std::string name;
+			schema_node type;
+		};
+
+		constexpr std::uint32_t schema_member_id(std::string_view name) noexcept{
+			return static_cast<std::uint32_t>(metapp::detail::hash_name(name));
+		}
+
+		inline bool read_schema(binary_reader &r, schema_node &node, unsigned depth = 0){
+			unsigned char code;
+			if(depth > 64 || !r.read(&code, 1)) return false;
+
+			node.code = static_cast<schema_code>(code);
+
+			switch(node.code){
+				case schema_code::bool_: return true;
+
+				case schema_code::int_:
+				case schema_code::uint_:
+				case schema_code::enum_:
+				case schema_code::float_:
+				case schema_code::string:{
+					if(!r.read(&node.width, 1)) return false;
+
+					const auto w = node.width;
+					if(node.code == schema_code::float_) return w == 4 || w == 8;
+					else if(node.code == schema_code::string) return w == 1 || w == 2 || w == 4;
+					else return w == 1 || w == 2 || w == 4 || w == 8;
+				}
+
+				case schema_code::array:
+					if(!read_varint(r, node.count)) return false;
+					[[fallthrough]];
+
+				case schema_code::vector:
+				case schema_code::optional:
+					return read_schema(r, node.element.emplace_back(), depth + 1);
+
+				case schema_code::class_:{
+					std::uint64_t n;
+					if(!read_varint(r, n) || n > r.remaining()) return false;
+
+					node.fields.resize(n);
+
+					for(auto &&field : node.fields){
+						std::uint64_t id, name_len;
+						if(!read_uint(r, id, 4) || !read_varint(r, name_len) || name_len > r.remaining()) return false;
+
+						field.id = static_cast<std::uint32_t>(id);
+						field.name.resize(name_len);
+
+						if(!r.read(field.name.data(), name_len) || !read_schema(r, field.type, depth + 1)) return false;
+					}
+
+					return true;
+				}
+
+				default: return false;
+			}
+		}
+
+		inline bool same_schema(const schema_node &a, const schema_node &b) noexcept{
+			if(
+				a.code != b.code || a.width != b.width || a.count != b.count ||
+				a.element.size() != b.element.size() || a.fields.size() != b.fields.size()
+			){
+				return false;
+			}
+
+			for(std::size_t i = 0; i < a.element.size(); i++){
+				if(!same_schema(a.element[i], b.element[i])) return false;
+			}
+
+			for(std::size_t i = 0; i < a.fields.size(); i++){
+				auto &&fa = a.fields[i];
+				auto &&fb = b.fields[i];
+				if(fa.id != fb.id || fa.name != fb.name || !same_schema(fa.type, fb.type)) return false;
+			}
+
+			return true;
+		}
+
+		// fewest bytes a value can be encoded in, only values that always encode to nothing give `0`
+		inline std::uint64_t min_wire_size(const schema_node &node) noexcept{
+			switch(node.code){
+				case schema_code::bool_: return 1;
+
+				case schema_code::int_:
+				case schema_code::uint_:
+				case schema_code::enum_:
+				case schema_code::float_:
+					return node.width;
+
+				case schema_code::array:{
+					const auto elem = min_wire_size(node.element[0]);
+					if(elem && node.count > std::numeric_limits<std::uint64_t>::max() / elem) return std::numeric_limits<std::uint64_t>::max();
+					return node.count * elem;
+				}
+
+				case schema_code::class_:{
+					constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+
+					std::uint64_t ret = 0;
+					for(auto &&field : node.fields){
+						const auto size = min_wire_size(field.type);
+						ret = size > max - ret ? max : ret + size;
+					}
+					return ret;
+				}
+
+				default: return 1;
+			}
+		}
+
+		// checks `n` elements of `elem` could fit in the input before reading them one by one
+		inline bool fits_elements(const binary_reader &r, const schema_node &elem, std::uint64_t n) noexcept{
+			const auto min_size = min_wire_size(elem);
+			return min_size == 0 || n <= r.remaining() / min_size;
+		}
+
+		inline bool skip_value(binary_reader &r, const schema_node &node){
+			switch(node.code){
+				case schema_code::bool_: return r.skip(1);
+
+				case schema_code::int_:
+				case schema_code::uint_:
+				case schema_code::enum_:
+				case schema_code::float_:
+					return r.skip(node.width);
+
+				case schema_code::string:{
+					std::uint64_t n;
+					return read_varint(r, n) && n <= r.remaining() / node.width && r.skip(n * node.width);
+				}
+
+				case schema_code::vector:
+				case schema_code::array:{
+					auto &&elem = node.element[0];
+
+					std::uint64_t n = node.count;
+					if(node.code == schema_code::vector && !read_varint(r, n)) return false;
+					if(!fits_elements(r, elem, n)) return false;
+					if(min_wire_size(elem) == 0) return true;
+
+					for(std::uint64_t i = 0; i < n; i++){
+						if(!skip_value(r, elem)) return false;
+					}
+
+					return true;
+				}
+
+				case schema_code::optional:{
+					unsigned char has_value;
+					if(!r.read(&has_value, 1) || has_value > 1) return false;
+					return !has_value || skip_value(r, node.element[0]);
+				}
+
+				case schema_code::class_:{
+					for(auto &&field : node.fields){
+						if(!skip_value(r, field.type)) return false;
+					}
+
+					return true;
+				}
+
+				default: return false;
+			}
+		}
+
+		inline bool is_numeric(schema_code code) noexcept{
+			switch(code){
+				case schema_code::bool_:
+				case schema_code::int_:
+				case schema_code::uint_:
+				case schema_code::enum_:
+				case schema_code::float_:
+					return true;
+
+				default: return false;
+			}
+		}
+
+		// whether an integer read as `bits`, sign extended if `is_signed`, is representable in the integer `T`
+		template<typename T>
+		bool int_in_range(std::uint64_t bits, bool is_signed) noexcept{
+			constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+
+			if(is_signed && static_cast<std::int64_t>(bits) < 0){
+				return std::is_signed_v<T> && static_cast<std::int64_t>(bits) >= static_cast<std::int64_t>(std::numeric_limits<T>::min());
+			}
+
+			return bits <= max;
+		}
+
+		// reads any numeric encoding into an arithmetic or enum value, out of range values leave `val` as is
+		template<typename T>
+		bool read_number(binary_reader &r, const schema_node &wire, T &val){
+			std::uint64_t bits;
+
+			if(wire.code == schema_code::bool_){
+				if(!read_uint(r, bits, 1) || bits > 1) return false;
+			}
+			else if(!read_uint(r, bits, wire.width)){
+				return false;
+			}
+
+			if(wire.code == schema_code::float_){
+				double f;
+
+				if(wire.width == 4){
+					const auto bits32 = static_cast<std::uint32_t>(bits);
+					float f32;
+					std::memcpy(&f32, &bits32, 4);
+					f = f32;
+				}
+				else{
+					std::memcpy(&f, &bits, 8);
+				}
+
+				if constexpr(std::is_same_v<T, bool>){
+					val = f != 0.0;
+				}
+				else if constexpr(std::is_floating_point_v<T>){
+					val = static_cast<T>(f);
+				}
+				else if constexpr(std::is_integral_v<T>){
+					const double hi = std::ldexp(1.0, std::numeric_limits<T>::digits);
+					const double lo = std::is_signed_v<T> ? -hi : 0.0;
+					if(f >= lo && f < hi) val = static_cast<T>(f);
+				}
+
+				return true;
+			}
+
+			if(wire.code == schema_code::int_ && wire.width < 8){
+				const unsigned shift = 64 - (wire.width * 8);
+				bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(bits << shift) >> shift);
+			}
+
+			if constexpr(std::is_same_v<T, bool>){
+				val = bits != 0;
+			}
+			else if constexpr(std::is_floating_point_v<T>){
+				val = wire.code == schema_code::int_ ? static_cast<T>(static_cast<std::int64_t>(bits)) : static_cast<T>(bits);
+			}
+			else if constexpr(std::is_enum_v<T>){
+				using underlying = std::underlying_type_t<T>;
+				if(int_in_range<underlying>(bits, wire.code == schema_code::int_)) val = static_cast<T>(static_cast<underlying>(bits));
+			}
+			else{
+				if(int_in_range<T>(bits, wire.code == schema_code::int_)) val = static_cast<T>(bits);
+			}
+
+			return true;
+		}
+
+		template<typename T>
+		using stream_reader = std::function<bool(binary_reader&, T&)>;
+
+		/**
+		 * @brief Schema of the `binary_codec` encoding of a type, and readers converting from other encodings.
+		 *
+		 * `compile` returns an empty reader if values of the schema can't be converted to `T`.
+		 */
+		template<typename T, typename = void>
+		struct binary_schema{
+			static_assert(!std::is_same_v<T, T>, "type has no binary encoding");
+		};
+
+		template<typename T>
+		stream_reader<T> compile_stream_reader(const schema_node &wire);
+
+		template<typename Writer>
+		bool write_schema_code(Writer &w, schema_code code){
+			const auto byte = static_cast<unsigned char>(code);
+			return w.write(&byte, 1);
+		}
+
+		template<typename Writer>
+		bool write_schema_code(Writer &w, schema_code code, std::size_t width){
+			const unsigned char bytes[] = { static_cast<unsigned char>(code), static_cast<unsigned char>(width) };
+			return w.write(bytes, 2);
+		}
+
+		template<typename T>
+		struct binary_schema<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>{
+			template<typename Writer>
+			static bool write(Writer &w){
+				if constexpr(std::is_same_v<T, bool>){
+					return write_schema_code(w, schema_code::bool_);
+				}
+				else if constexpr(std::is_enum_v<T>){
+					return write_schema_code(w, schema_code::enum_, binary_codec<T>::size);
+				}
+				else if constexpr(std::is_floating_point_v<T>){
+					return write_schema_code(w, schema_code::float_, sizeof(T));
+				}
+				else{
+					return write_schema_code(w, std::is_signed_v<T> ? schema_code::int_ : schema_code::uint_, sizeof(T));
+				}
+			}
+
+			static stream_reader<T> compile(const schema_node &wire){
+				// enums don't take floating point values
+				if(!is_numeric(wire.code) || (std::is_enum_v<T> && wire.code == schema_code::float_)) return nullptr;
+				return [&wire](binary_reader &r, T &val){ return read_number(r, wire, val); };
+			}
+		};
+
+		template<typename Char, typename Traits, typename Alloc>
+		struct binary_schema<std::basic_string<Char, Traits, Alloc>>{
+			template<typename Writer>
+			static bool write(Writer &w){
+				return write_schema_code(w, schema_code::string, sizeof(Char));
+			}
+
+			// strings of another character width aren't converted
+			static stream_reader<std::basic_string<Char, Traits, Alloc>> compile(const schema_node&){ return nullptr; }
+		};
+
+		template<typename T, typename Alloc>
+		struct binary_schema<std::vector<T, Alloc>, std::enable_if_t<!std::is_same_v<T, bool>>>{
+			template<typename Writer>
+			static bool write(Writer &w){
+				return write_schema_code(w, schema_code::vector) && binary_schema<T>::write(w);
+			}
+
+			static stream_reader<std::vector<T, Alloc>> compile(const schema_node &wire){
+				if(wire.code != schema_code::vector && wire.code != schema_code::array) return nullptr;
+
+				auto &&elem = wire.element[0];
+				auto read_elem = compile_stream_reader<T>(elem);
+				if(!read_elem) return nullptr;
+
+				return [&wire, &elem, read_elem = std::move(read_elem)](binary_reader &r, std::vector<T, Alloc> &val){
+					std::uint64_t n = wire.count;
+					if(wire.code == schema_code::vector && !read_varint(r, n)) return false;
+
+					// nothing bounds a length of elements that take no input, and vectors of them are never written
+					if(!fits_elements(r, elem, n) || (n && min_wire_size(elem) == 0)) return false;
+
+					val.clear();
+					val.reserve(std::min<std::uint64_t>(n, r.remaining()));
+
+					for(std::uint64_t i = 0; i < n; i++){
+						if(!read_elem(r, val.emplace_back())) return false;
+					}
+
+					return true;
+				};
+			}
+		};
+
+		template<typename T, std::size_t N>
+		struct binary_schema<std::array<T, N>>{
+			template<typename Writer>
+			static bool write(Writer &w){
+				return write_schema_code(w, schema_code::array) && write_varint(w, N) && binary_schema<T>::write(w);
+			}
+
+			// elements past the end of the array are skipped, missing elements keep their value
+			static stream_reader<std::array<T, N>> compile(const schema_node &wire){
+				if(wire.code != schema_code::vector && wire.code != schema_code::array) return nullptr;
+
+				auto &&elem = wire.element[0];
+				auto read_elem = compile_stream_reader<T>(elem);
+				if(!read_elem) return nullptr;
+
+				return [&wire, &elem, read_elem = std::move(read_elem)](binary_reader &r, std::array<T, N> &val){
+					std::uint64_t n = wire.count;
+					if(wire.code == schema_code::vector && !read_varint(r, n)) return false;
+					if(!fits_elements(r, elem, n)) return false;
+
+					// skipping elements that take no input reads nothing
+					if(min_wire_size(elem) == 0) n = std::min<std::uint64_t>(n, N);
+
+					for(std::uint64_t i = 0; i < n; i++){
+						if(!(i < N ? read_elem(r, val[i]) : skip_value(r, elem))) return false;
+					}
+
+					return true;
+				};
+			}
+		};
+
+		template<typename T>
+		struct binary_schema<std::optional<T>>{
+			template<typename Writer>
+			static bool write(Writer &w){
+				return write_schema_code(w, schema_code::optional) && binary_schema<T>::write(w);
+			}
+
+			// values that were never optional are read as engaged
+			static stream_reader<std::optional<T>> compile(const schema_node &wire){
+				if(wire.code != schema_code::optional){
+					auto read_value = compile_stream_reader<T>(wire);
+					if(!read_value) return nullptr;
+
+					return [read_value = std::move(read_value)](binary_reader &r, std::optional<T> &val){
+						return read_value(r, val.emplace());
+					};
+				}
+
+				auto read_value = compile_stream_reader<T>(wire.element[0]);
+				if(!read_value) return nullptr;
+
+				return [read_value = std::move(read_value)](binary_reader &r, std::optional<T> &val){
+					unsigned char has_value;
+					if(!r.read(&has_value, 1) || has_value > 1) return false;
+
+					if(!has_value){
+						val.reset();
+						return true;
+					}
+
+					return read_value(r, val.emplace());
+				};
+			}
+		};
+
+		template<typename Class, typename Members = metapp::members<Class>, typename Bases = encoded_bases<Class>>
+		struct class_schema;
+
+		// the fields of public bases come first, as they are written by `binary_codec`
+		template<typename Class, typename ... Members, typename ... Bases>
+		struct class_schema<Class, metapp::types<Members...>, metapp::types<Bases...>>{
+			using members = metapp::types<Members...>;
+
+			static constexpr std::size_t num_fields =
+				(std::size_t(0) + ... + class_schema<Bases>::num_fields) + (std::size_t(0) + ... + std::size_t(Members::is_accessable));
+
+			template<typename Member, typename Writer>
+			static bool write_member(Writer &w){
+				if constexpr(!Member::is_accessable){
+					return true;
+				}
+				else{
+					return
+						write_uint(w, schema_member_id(Member::name), 4) &&
+						write_varint(w, Member::name.size()) && w.write(Member::name.data(), Member::name.size()) &&
+						binary_schema<typename Member::type>::write(w);
+				}
+			}
+
+			template<typename Writer>
+			static bool write_fields(Writer &w){
+				return (class_schema<Bases>::write_fields(w) && ...) && (write_member<Members>(w) && ...);
+			}
+
+			template<typename Writer>
+			static bool write(Writer &w){
+				return write_schema_code(w, schema_code::class_) && write_varint(w, num_fields) && write_fields(w);
+			}
+
+			template<std::size_t I>
+			static stream_reader<Class> compile_member(const schema_field &field){
+				using member = metapp::get_t<members, I>;
+
+				if constexpr(!member::is_accessable){
+					return nullptr;
+				}
+				else{
+					if(field.id != schema_member_id(member::name) || field.name != member::name) return nullptr;
+
+					auto read_member = compile_stream_reader<typename member::type>(field.type);
+					if(!read_member) return nullptr;
+
+					return [read_member = std::move(read_member)](binary_reader &r, Class &cls){
+						return read_member(r, member::get(cls));
+					};
+				}
+			}
+
+			template<std::size_t ... Is>
+			static stream_reader<Class> compile_member(const schema_field &field, std::index_sequence<Is...>){
+				stream_reader<Class> ret;
+				((ret = compile_member<Is>(field)) || ...);
+				return ret;
+			}
+
+			template<typename Base>
+			static stream_reader<Class> compile_base_field(const schema_field &field){
+				auto read_base = class_schema<Base>::compile_field(field);
+				if(!read_base) return nullptr;
+
+				return [read_base = std::move(read_base)](binary_reader &r, Class &cls){
+					return read_base(r, static_cast<Base&>(cls));
+				};
+			}
+
+			// members of the class itself hide members of its bases with the same name
+			static stream_reader<Class> compile_field(const schema_field &field){
+				stream_reader<Class> ret = compile_member(field, std::make_index_sequence<sizeof...(Members)>());
+				(ret || ... || (ret = compile_base_field<Bases>(field)));
+				return ret;
+			}
+
+			// each written member maps to a reader of a member with the same name or is skipped,
+			// members that weren't written keep their value
+			static stream_reader<Class> compile(const schema_node &wire){
+				if(wire.code != schema_code::class_) return nullptr;
+
+				struct step{
+					const schema_node *wire;
+					stream_reader<Class> read;
+				};
+
+				std::vector<step> steps;
+				steps.reserve(wire.fields.size());
+
+				for(auto &&field : wire.fields){
+					steps.push_back({ &field.type, compile_field(field) });
+				}
+
+				return [steps = std::move(steps)](binary_reader &r, Class &cls){
+					for(auto &&s : steps){
+						if(!(s.read ? s.read(r, cls) : skip_value(r, *s.wire))) return false;
+					}
+
+					return true;
+				};
+			}
+		};
+
+		template<typename Class>
+		struct binary_schema<Class, std::enable_if_t<metapp::has_info<Class>>>: class_schema<Class>{};
+
+		template<typename T>
+		const std::vector<unsigned char> &local_schema_bytes(){
+			static const std::vector<unsigned char> bytes = []{
+				std::vector<unsigned char> ret;
+				binary_appender w(ret);
+				binary_schema<T>::write(w);
+				return ret;
+			}();
+
+			return bytes;
+		}
+
+		template<typename T>
+		const schema_node &local_schema(){
+			static const schema_node node = []{
+				auto &&bytes = local_schema_bytes<T>();
+				binary_reader r(bytes.data(), bytes.size());
+
+				schema_node ret;
+				read_schema(r, ret);
+				return ret;
+			}();
+
+			return node;
+		}
+
+		template<typename T>
+		stream_reader<T> compile_stream_reader(const schema_node &wire){
+			if(same_schema(wire, local_schema<T>())){
+				return [](binary_reader &r, T &val){ return binary_codec<T>::read(val, r); };
+			}
+
+			auto ret = binary_schema<T>::compile(wire);
+
+			// values that are no longer optional are read if present and otherwise keep their value
+			if(!ret && wire.code == schema_code::optional){
+				auto read_value = compile_stream_reader<T>(wire.element[0]);
+				if(!read_value) return nullptr;
+
+				return [read_value = std::move(read_value)](binary_reader &r, T &val){
+					unsigned char has_value;
+					if(!r.read(&has_value, 1) || has_value > 1) return false;
+					return has_value ? read_value(r, val) : true;
+				};
+			}
+
+			return ret;
+		}
+
+		inline constexpr std::uint32_t stream_magic = 0x53425053;
+		inline constexpr unsigned char stream_version = 1;
+	}
+
+	/**
+	 * @brief Writes a stream of values that readers built against other versions of `T` can decode.
+	 *
+	 * The stream starts with the layout fingerprint of `T` and a schema of its encoding (member names,
+	 * ids and type codes), written once, followed by each value encoded as by `to_binary`.
+	 */
+	template<typename T>
+	class binary_stream_writer{
+		public:
+			binary_stream_writer(){
+				auto &&schema = detail::local_schema_bytes<T>();
+
+				detail::binary_appender w(m_data);
+				detail::write_uint(w, detail::stream_magic, 4);
+				w.write(&detail::stream_version, 1);
+				detail::write_uint(w, metapp::layout_fingerprint<T>, 8);
+				detail::write_varint(w, schema.size());
+				w.write(schema.data(), schema.size());
+			}
+
+			/**
+			 * @brief Append a value to the stream.
+			 * @returns whether the value could be encoded, the stream is left unchanged if not
+			 */
+			bool write(const T &val){
+				const auto prev_size = m_data.size();
+
+				detail::binary_appender w(m_data);
+				if(!detail::binary_codec<T>::write(val, w)){
+					m_data.resize(prev_size);
+					return false;
+				}
+
+				return true;
+			}
+
+			const std::vector<unsigned char> &data() const noexcept{ return m_data; }
+
+		private:
+			std::vector<unsigned char> m_data;
+	};
+
+	/**
+	 * @brief Reads values from a stream written by `binary_stream_writer`.
+	 *
+	 * If the stream was written with the same layout and schema as `T` values are decoded exactly as by
+	 * `from_binary`. Otherwise a mapping from the written schema is compiled once when the stream is opened:
+	 * members are matched by id and name, numbers are converted between widths and kinds, members no longer
+	 * in `T` are skipped and members missing from the stream keep their default value.
+	 */
+	template<typename T>
+	class binary_stream_reader{
+		public:
+			/**
+			 * @returns `std::nullopt` if the data isn't a stream or its schema can't be converted to `T`
+			 */
+			static std::optional<binary_stream_reader> open(const void *data, std::size_t size){
+				detail::binary_reader r(data, size);
+
+				std::uint64_t magic, fingerprint, schema_size;
+				unsigned char version;
+
+				if(
+					!detail::read_uint(r, magic, 4) || magic != detail::stream_magic ||
+					!r.read(&version, 1) || version != detail::stream_version ||
+					!detail::read_uint(r, fingerprint, 8) ||
+					!detail::read_varint(r, schema_size) || schema_size > r.remaining()
+				){
+					return std::nullopt;
+				}
+
+				const auto schema_data = static_cast<const unsigned char*>(data) + r.size();
+				r.skip(schema_size);
+
+				binary_stream_reader ret(detail::binary_reader(static_cast<const unsigned char*>(data) + r.size(), r.remaining()));
+
+				auto &&local = detail::local_schema_bytes<T>();
+				if(
+					fingerprint == metapp::layout_fingerprint<T> &&
+					schema_size == local.size() && std::equal(local.begin(), local.end(), schema_data)
+				){
+					return ret;
+				}
+
+				auto schema = std::make_shared<detail::schema_node>();
+				detail::binary_reader schema_reader(schema_data, schema_size);
+
+				if(!detail::read_schema(schema_reader, *schema) || schema_reader.remaining()) return std::nullopt;
+
+				ret.m_read = detail::compile_stream_reader<T>(*schema);
+				if(!ret.m_read) return std::nullopt;
+
+				ret.m_schema = std::move(schema);
+				return ret;
+			}
+
+			/**
+			 * @brief Whether values are read directly, without converting from another schema.
+			 */
+			bool is_exact() const noexcept{ return !m_read; }
+
+			bool at_end() const noexcept{ return m_reader.remaining() == 0; }
+
+			/**
+			 * @brief Read the next value.
+			 * @returns `false` at the end of the stream or if the value is malformed
+			 */
+			bool read(T &out){
+				if(at_end()) return false;
+				return m_read ? m_read(m_reader, out) : detail::binary_codec<T>::read(out, m_reader);
+			}
+
+		private:
+			explicit binary_stream_reader(detail::binary_reader r) noexcept: m_reader(r){}
+
+			detail::binary_reader m_reader;
+			std::shared_ptr<const detail::schema_node> m_schema;
+			detail::stream_reader<T> m_read;
+	};
+
+	/**
+	 * @brief Read-only view of a contiguous array inside a serialized buffer.
+	 */
+	template<typename T>
+	class array_view{
+		public:
+			constexpr array_view() noexcept = default;
+			constexpr array_view(const T *data, std::size_t size) noexcept: m_data(data), m_size(size){}
+
+			constexpr const T *data() const noexcept{ return m_data; }
+			constexpr std::size_t size() const noexcept{ return m_size; }
+			constexpr bool empty() const noexcept{ return m_size == 0; }
+
+			constexpr const T *begin() const noexcept{ return m_data; }
+			constexpr const T *end() const noexcept{ return m_data + m_size; }
+
+			constexpr const T &operator[](std::size_t idx) const noexcept{ return m_data[idx]; }
+
+		#if __cplusplus >= 202002L
+			constexpr operator std::span<const T>() const noexcept{ return std::span<const T>(m_data, m_size); }
+		#endif
+
+		private:
+			const T *m_data = nullptr;
+			std::size_t m_size = 0;
+	};
+
+	template<typename T>
+	class view;
+
+	namespace detail{
+		constexpr std::size_t align_up(std::size_t n, std::size_t alignment) noexcept{
+			return (n + alignment - 1) & ~(alignment - 1);
+		}
+
+		template<typename T>
+		T load_le(const unsigned char *p) noexcept{
+			T ret;
+
+			if constexpr(is_little_endian || sizeof(T) == 1){
+				std::memcpy(&ret, p, sizeof(T));
+			}
+			else{
+				unsigned char bytes[sizeof(T)];
+				std::reverse_copy(p, p + sizeof(T), bytes);
+				std::memcpy(&ret, bytes, sizeof(T));
+			}
+
+			return ret;
+		}
+
+		template<typename T>
+		void store_le(unsigned char *p, T val) noexcept{
+			std::memcpy(p, &val, sizeof(T));
+
+			if constexpr(!is_little_endian && sizeof(T) > 1){
+				std::reverse(p, p + sizeof(T));
+			}
+		}
+
+		// where a member's data lives in a view record, variable length data is an (offset, size) pair into the heap
+		template<typename T, typename = void>
+		struct view_slot{
+			static_assert(!std::is_same_v<T, T>, "type can not be stored in a view");
+		};
+
+		template<typename T>
+		struct view_slot<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>{
+			static_assert(!std::is_same_v<T, long double> && alignof(T) <= 8, "type has no portable view encoding");
+
+			static constexpr std::size_t size = sizeof(T), alignment = alignof(T);
+
+			static void store(const T &val, unsigned char *slot, std::vector<unsigned char>&){
+				if constexpr(std::is_enum_v<T>){
+					store_le(slot, static_cast<std::underlying_type_t<T>>(val));
+				}
+				else{
+					store_le(slot, val);
+				}
+			}
+
+			static T load(const unsigned char *slot, const unsigned char*, std::size_t) noexcept{
+				if constexpr(std::is_enum_v<T>){
+					return static_cast<T>(load_le<std::underlying_type_t<T>>(slot));
+				}
+				else{
+					return load_le<T>(slot);
+				}
+			}
+		};
+
+		template<typename T>
+		struct heap_slot{
+			static_assert(is_raw<T>::value && alignof(T) <= 8, "elements must be trivially copyable scalars stored little-endian");
+
+			static constexpr std::size_t size = 16, alignment = 8;
+
+			static void store(const T *data, std::size_t n, unsigned char *slot, std::vector<unsigned char> &heap){
+				const auto offset = align_up(heap.size(), alignof(T));
+				heap.resize(offset + (n * sizeof(T)));
+				if(n) std::memcpy(heap.data() + offset, data, n * sizeof(T));
+
+				store_le<std::uint64_t>(slot, offset);
+				store_le<std::uint64_t>(slot + 8, n);
+			}
+
+			// out of bounds ranges from a corrupt file read as empty
+			static array_view<T> load(const unsigned char *slot, const unsigned char *heap, std::size_t heap_size) noexcept{
+				const auto offset = load_le<std::uint64_t>(slot);
+				const auto n = load_le<std::uint64_t>(slot + 8);
+
+				if(offset > heap_size || offset % alignof(T) != 0 || n > (heap_size - offset) / sizeof(T)){
+					return {};
+				}
+
+				return array_view<T>(reinterpret_cast<const T*>(heap + offset), n);
+			}
+		};
+
+		template<typename Traits, typename Alloc>
+		struct view_slot<std::basic_string<char, Traits, Alloc>>{
+			static constexpr std::size_t size = 16, alignment = 8;
+
+			static void store(const std::basic_string<char, Traits, Alloc> &val, unsigned char *slot, std::vector<unsigned char> &heap){
+				heap_slot<char>::store(val.data(), val.size(), slot, heap);
+			}
+
+			static std::string_view load(const unsigned char *slot, const unsigned char *heap, std::size_t heap_size) noexcept{
+				const auto chars = heap_slot<char>::load(slot, heap, heap_size);
+				return std::string_view(chars.data(), chars.size());
+			}
+		};
+
+		template<typename T, typename Alloc>
+		struct view_slot<std::vector<T, Alloc>>: heap_slot<T>{
+			static void store(const std::vector<T, Alloc> &val, unsigned char *slot, std::vector<unsigned char> &heap){
+				heap_slot<T>::store(val.data(), val.size(), slot, heap);
+			}
+
+			using heap_slot<T>::load;
+		};
+
+		template<typename T, std::size_t N>
+		struct view_slot<std::array<T, N>>{
+			static_assert(is_raw<T>::value && alignof(T) <= 8, "elements must be trivially copyable scalars stored little-endian");
+
+			static constexpr std::size_t size = sizeof(T) * N, alignment = alignof(T);
+
+			static void store(const std::array<T, N> &val, unsigned char *slot, std::vector<unsigned char>&){
+				std::memcpy(slot, val.data(), size);
+			}
+
+			static array_view<T> load(const unsigned char *slot, const unsigned char*, std::size_t) noexcept{
+				return array_view<T>(reinterpret_cast<const T*>(slot), N);
+			}
+		};
+
+		template<typename Class, typename Members = metapp::members<Class>>
+		struct view_layout;
+
+		template<typename Class, typename ... Members>
+		struct view_layout<Class, metapp::types<Members...>>{
+			// records are indexed by member, there is no slot for a base
+			static_assert(std::is_same_v<encoded_bases<Class>, metapp::types<>>, "classes with public bases holding data can't be viewed");
+
+			using members = metapp::types<Members...>;
+
+			template<typename Member>
+			static constexpr std::size_t slot_size() noexcept{
+				if constexpr(Member::is_accessable) return view_slot<std::decay_t<typename Member::type>>::size;
+				else return 0;
+			}
+
+			template<typename Member>
+			static constexpr std::size_t slot_alignment() noexcept{
+				if constexpr(Member::is_accessable) return view_slot<std::decay_t<typename Member::type>>::alignment;
+				else return 1;
+			}
+
+			static constexpr std::size_t sizes[] = { slot_size<Members>()..., 0 };
+			static constexpr std::size_t alignments[] = { slot_alignment<Members>()..., 1 };
+
+			static constexpr std::size_t alignment = std::max({ std::size_t(1), slot_alignment<Members>()... });
+
+			struct offsets_t{
+				std::size_t offsets[sizeof...(Members) + 1];
+				std::size_t size;
+			};
+
+			static constexpr offsets_t make_offsets() noexcept{
+				offsets_t ret{};
+				std::size_t end = 0;
+
+				for(std::size_t i = 0; i < sizeof...(Members); i++){
+					ret.offsets[i] = align_up(end, alignments[i]);
+					end = ret.offsets[i] + sizes[i];
+				}
+
+				ret.size = align_up(end, alignment);
+				return ret;
+			}
+
+			static constexpr offsets_t layout = make_offsets();
+			static constexpr std::size_t size = layout.size;
+
+			template<std::size_t I>
+			static constexpr std::size_t offset = layout.offsets[I];
+
+			template<std::size_t I>
+			static void store_member(const Class &val, unsigned char *record, std::vector<unsigned char> &heap){
+				using member = metapp::get_t<members, I>;
+
+				if constexpr(member::is_accessable){
+					view_slot<std::decay_t<typename member::type>>::store(member::get(val), record + offset<I>, heap);
+				}
+			}
+
+			template<std::size_t ... Is>
+			static void store(const Class &val, unsigned char *record, std::vector<unsigned char> &heap, std::index_sequence<Is...>){
+				(store_member<Is>(val, record, heap), ...);
+			}
+
+			static void store(const Class &val, unsigned char *record, std::vector<unsigned char> &heap){
+				store(val, record, heap, std::make_index_sequence<sizeof...(Members)>());
+			}
+		};
+
+		template<typename Class>
+		struct view_slot<Class, std::enable_if_t<metapp::has_info<Class>>>{
+			static constexpr std::size_t size = view_layout<Class>::size, alignment = view_layout<Class>::alignment;
+
+			static void store(const Class &val, unsigned char *slot, std::vector<unsigned char> &heap){
+				view_layout<Class>::store(val, slot, heap);
+			}
+
+			static view<Class> load(const unsigned char *slot, const unsigned char *heap, std::size_t heap_size) noexcept{
+				return view<Class>(slot, heap, heap_size);
+			}
+		};
+
+		inline constexpr std::uint32_t view_magic = 0x57565052;
+		inline constexpr std::uint32_t view_version = 1;
+
+		/**
+		 * @brief Header at the start of a view buffer, every field is little-endian.
+		 * Records follow the header and the heap of variable length data follows the records.
+		 */
+		struct view_header{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint64_t type_id;
+			std::uint64_t layout_fingerprint;
+			std::uint64_t record_size;
+			std::uint64_t num_records;
+			std::uint64_t heap_offset;
+			std::uint64_t heap_size;
+		};
+	}
+
+	/**
+	 * @brief Accessors for one record of a view buffer, reading members straight from the buffer.
+	 *
+	 * Scalars and enums are returned by value, strings as `std::string_view`, vectors and arrays
+	 * as `array_view` and nested reflected classes as another `view`.
+	 */
+	template<typename T>
+	class view{
+		public:
+			using layout = detail::view_layout<T>;
+
+			view(const unsigned char *record, const unsigned char *heap, std::size_t heap_size) noexcept
+				: m_record(record), m_heap(heap), m_heap_size(heap_size){}
+
+			/**
+			 * @brief Get a member by index into `metapp::members<T>`.
+			 */
+			template<std::size_t I>
+			auto get() const noexcept{
+				using member = metapp::get_t<typename layout::members, I>;
+				static_assert(member::is_accessable, "inaccessible members are not stored");
+
+				using slot = detail::view_slot<std::decay_t<typename member::type>>;
+				return slot::load(m_record + layout::template offset<I>, m_heap, m_heap_size);
+			}
+
+		#if __cplusplus >= 202002L
+			/**
+			 * @brief Get a member by name.
+			 */
+			template<metapp::fixed_str Name>
+			auto get() const noexcept{
+				constexpr std::size_t idx = member_index(Name, std::make_index_sequence<layout::members::size>());
+				static_assert(idx < layout::members::size, "no member with that name");
+				return get<idx>();
+			}
+		#endif
+
+		private:
+		#if __cplusplus >= 202002L
+			template<std::size_t ... Is>
+			static constexpr std::size_t member_index(std::string_view name, std::index_sequence<Is...>) noexcept{
+				std::size_t ret = sizeof...(Is);
+				((metapp::get_t<typename layout::members, Is>::name == name ? (ret = Is, true) : false) || ...);
+				return ret;
+			}
+		#endif
+
+			const unsigned char *m_record;
+			const unsigned char *m_heap;
+			std::size_t m_heap_size;
+	};
+
+	/**
+	 * @brief Builds a buffer of `T` records that can be read in place through `view<T>`.
+	 */
+	template<typename T>
+	class view_builder{
+		public:
+			using layout = detail::view_layout<T>;
+
+			void add(const T &val){
+				const auto offset = m_records.size();
+				m_records.resize(offset + layout::size);
+				layout::store(val, m_records.data() + offset, m_heap);
+				++m_num_records;
+			}
+
+			std::size_t size() const noexcept{ return m_num_records; }
+
+			/**
+			 * @brief Get the finished buffer: header, records then heap.
+			 */
+			std::vector<unsigned char> finish() const{
+				const auto records_offset = detail::align_up(sizeof(detail::view_header), 8);
+				const auto heap_offset = detail::align_up(records_offset + m_records.size(), 8);
+
+				std::vector<unsigned char> ret(heap_offset + m_heap.size());
+
+				unsigned char *header = ret.data();
+				detail::store_le(header + offsetof(detail::view_header, magic), detail::view_magic);
+				detail::store_le(header + offsetof(detail::view_header, version), detail::view_version);
+				detail::store_le(header + offsetof(detail::view_header, type_id), metapp::type_id<T>);
+				detail::store_le(header + offsetof(detail::view_header, layout_fingerprint), metapp::layout_fingerprint<T>);
+				detail::store_le<std::uint64_t>(header + offsetof(detail::view_header, record_size), layout::size);
+				detail::store_le<std::uint64_t>(header + offsetof(detail::view_header, num_records), m_num_records);
+				detail::store_le<std::uint64_t>(header + offsetof(detail::view_header, heap_offset), heap_offset);
+				detail::store_le<std::uint64_t>(header + offsetof(detail::view_header, heap_size), m_heap.size());
+
+				if(!m_records.empty()) std::memcpy(ret.data() + records_offset, m_records.data(), m_records.size());
+				if(!m_heap.empty()) std::memcpy(ret.data() + heap_offset, m_heap.data(), m_heap.size());
+
+				return ret;
+			}
+
+			/**
+			 * @brief Write the finished buffer to a file.
+			 * @throws std::runtime_error if the file can not be written
+			 */
+			void write(const std::filesystem::path &path) const{
+				const auto data = finish();
+
+				std::ofstream file(path, std::ios::binary | std::ios::trunc);
+				if(!file.write(reinterpret_cast<const char*>(data.data()), data.size())){
+					throw std::runtime_error(fmt::format("Error writing view file '{}'", path.string()));
+				}
+			}
+
+		private:
+			std::vector<unsigned char> m_records, m_heap;
+			std::size_t m_num_records = 0;
+	};
+
+	/**
+	 * @brief Read-only memory mapping of a file.
+	 */
+	class mapped_file{
+		public:
+			/**
+			 * @throws std::runtime_error if the file can not be mapped
+			 */
+			explicit mapped_file(const std::filesystem::path &path){
+				std::error_code ec;
+				m_size = std::filesystem::file_size(path, ec);
+				if(ec){
+					throw std::runtime_error(fmt::format("Error mapping '{}': {}", path.string(), ec.message()));
+				}
+
+				if(m_size == 0) return;
+
+			#ifdef _WIN32
+				auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if(file != INVALID_HANDLE_VALUE){
+					auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					if(mapping){
+						m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+						CloseHandle(mapping);
+					}
+					CloseHandle(file);
+				}
+			#else
+				const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if(fd != -1){
+					auto mem = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if(mem != MAP_FAILED) m_data = mem;
+					::close(fd);
+				}
+			#endif
+
+				if(!m_data){
+					throw std::runtime_error(fmt::format("Error mapping '{}'", path.string()));
+				}
+			}
+
+			~mapped_file(){
+				if(!m_data) return;
+
+			#ifdef _WIN32
+				UnmapViewOfFile(m_data);
+			#else
+				::munmap(m_data, m_size);
+			#endif
+			}
+
+			mapped_file(const mapped_file&) = delete;
+			mapped_file &operator=(const mapped_file&) = delete;
+
+			const void *data() const noexcept{ return m_data; }
+			std::size_t size() const noexcept{ return m_size; }
+
+		private:
+			void *m_data = nullptr;
+			std::size_t m_size = 0;
+	};
+
+	/**
+	 * @brief Records of a buffer written by `view_builder<T>`, accessed in place.
+	 */
+	template<typename T>
+	class view_table{
+		public:
+			using layout = detail::view_layout<T>;
+
+			/**
+			 * @brief Check the header of a buffer and wrap its records.
+			 * Only the header is validated, record contents are bounds checked as they are read.
+			 * @param owner kept alive as long as the table, e.g. the mapping holding `data`
+			 * @returns `std::nullopt` if the buffer doesn't hold records of `T` with the current layout
+			 */
+			static std::optional<view_table> from_buffer(const void *data, std::size_t size, std::shared_ptr<const void> owner = nullptr) noexcept{
+				using detail::view_header;
+
+				const auto bytes = static_cast<const unsigned char*>(data);
+				if(!bytes || size < sizeof(view_header) || reinterpret_cast<std::uintptr_t>(bytes) % 8 != 0) return std::nullopt;
+
+				const auto field = [bytes](std::size_t offset){ return detail::load_le<std::uint64_t>(bytes + offset); };
+
+				if(
+					detail::load_le<std::uint32_t>(bytes + offsetof(view_header, magic)) != detail::view_magic ||
+					detail::load_le<std::uint32_t>(bytes + offsetof(view_header, version)) != detail::view_version ||
+					field(offsetof(view_header, type_id)) != metapp::type_id<T> ||
+					field(offsetof(view_header, layout_fingerprint)) != metapp::layout_fingerprint<T> ||
+					field(offsetof(view_header, record_size)) != layout::size
+				){
+					return std::nullopt;
+				}
+
+				const auto records_offset = detail::align_up(sizeof(view_header), 8);
+				const auto num_records = field(offsetof(view_header, num_records));
+				const auto heap_offset = field(offsetof(view_header, heap_offset));
+				const auto heap_size = field(offsetof(view_header, heap_size));
+
+				if(
+					heap_offset % 8 != 0 || heap_offset > size || heap_size > size - heap_offset ||
+					heap_offset < records_offset || (layout::size && num_records > (heap_offset - records_offset) / layout::size)
+				){
+					return std::nullopt;
+				}
+
+				view_table ret;
+				ret.m_owner = std::move(owner);
+				ret.m_records = bytes + records_offset;
+				ret.m_num_records = num_records;
+				ret.m_heap = bytes + heap_offset;
+				ret.m_heap_size = heap_size;
+				return ret;
+			}
+
+			/**
+			 * @brief Map a file written by `view_builder<T>::write`.
+			 * @returns `std::nullopt` if the file can not be mapped or doesn't hold records of `T`
+			 */
+			static std::optional<view_table> open(const std::filesystem::path &path){
+				std::shared_ptr<const mapped_file> file;
+
+				try{
+					file = std::make_shared<const mapped_file>(path);
+				}
+				catch(const std::exception&){
+					return std::nullopt;
+				}
+
+				auto data = file->data();
+				auto size = file->size();
+				return from_buffer(data, size, std::move(file));
+			}
+
+			std::size_t size() const noexcept{ return m_num_records; }
+			bool empty() const noexcept{ return m_num_records == 0; }
+
+			view<T> operator[](std::size_t idx) const noexcept{
+				return view<T>(m_records + (idx * layout::size), m_heap, m_heap_size);
+			}
+
+		private:
+			view_table() = default;
+
+			std::shared_ptr<const void> m_owner;
+			const unsigned char *m_records = nullptr;
+			std::size_t m_num_records = 0;
+			const unsigned char *m_heap = nullptr;
+			std::size_t m_heap_size = 0;
+	};
+
+	/**
+	 * @brief Object layout written by `to_json`.
+	 */
+	enum class json_layout{
+		verbose, ///< `{"Class":[{"member":{"name":"m_0","type":"int","value":"69"}},...]}`, scalar members are quoted with bools as `"1"` or `"0"` and characters as themselves
+		compact ///< `{"m_0":69,...}`
+	};
+
+	namespace detail{
+		// length of the prefix of `str` that can be written without escaping
+		inline std::size_t json_plain_prefix(const char *str, std::size_t n) noexcept{
+			std::size_t i = 0;
+
+#ifdef METACPP_SERIAL_SSE2
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i max_control = _mm_set1_epi8(0x1f);
+
+			for(; i + 16 <= n; i += 16){
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+				const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk);
+				const __m128i special = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+					control
+				);
+
+				if(_mm_movemask_epi8(special)) break;
+			}
+#endif
+
+			for(; i < n; i++){
+				const auto c = static_cast<unsigned char>(str[i]);
+				if(c < 0x20 || c == '"' || c == '\\') return i;
+			}
+
+			return n;
+		}
+
+		inline void write_json_string(fmt::memory_buffer &out, std::string_view str){
+			out.push_back('"');
+
+			while(true){
+				const auto plain = json_plain_prefix(str.data(), str.size());
+				out.append(str.data(), str.data() + plain);
+
+				if(plain == str.size()) break;
+
+				const char c = str[plain];
+				str.remove_prefix(plain + 1);
+
+				switch(c){
+					case '"': out.append(std::string_view("\\\"")); break;
+					case '\\': out.append(std::string_view("\\\\")); break;
+					case '\b': out.append(std::string_view("\\b")); break;
+					case '\f': out.append(std::string_view("\\f")); break;
+					case '\n': out.append(std::string_view("\\n")); break;
+					case '\r': out.append(std::string_view("\\r")); break;
+					case '\t': out.append(std::string_view("\\t")); break;
+					default:{
+						constexpr std::string_view hex = "0123456789abcdef";
+						const char escaped[] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf] };
+						out.append(escaped, escaped + sizeof(escaped));
+						break;
+					}
+				}
+			}
+
+			out.push_back('"');
+		}
+
+		template<typename T>
+		struct is_optional: std::false_type{};
+
+		template<typename T>
+		struct is_optional<std::optional<T>>: std::true_type{};
+
+		template<typename T, typename = void>
+		struct is_json_range: std::false_type{};
+
+		template<typename T>
+		struct is_json_range<T, std::void_t<decltype(std::begin(std::declval<const T&>()), std::end(std::declval<const T&>()))>>: std::true_type{};
+
+		// written as characters by `operator<<`, so the verbose layout keeps them as one character strings
+		template<typename T>
+		inline constexpr bool is_json_char = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+		class json_writer{
+			public:
+				json_writer(fmt::memory_buffer &out, json_layout layout) noexcept
+					: m_out(out), m_layout(layout){}
+
+				template<typename T>
+				void write(const T &val){
+					if constexpr(std::is_same_v<T, bool>){
+						append(val ? "true" : "false");
+					}
+					else if constexpr(std::is_arithmetic_v<T>){
+						write_number(val);
+					}
+					else if constexpr(std::is_enum_v<T>){
+						write_enum(val);
+					}
+					else if constexpr(std::is_convertible_v<const T&, std::string_view>){
+						write_json_string(m_out, val);
+					}
+					else if constexpr(is_optional<T>::value){
+						if(val) write(*val);
+						else append("null");
+					}
+					else if constexpr(metapp::has_info<T>){
+						write_class(val, std::make_index_sequence<metapp::members<T>::size>());
+					}
+					else if constexpr(is_json_range<T>::value){
+						write_range(val);
+					}
+					else{
+						static_assert(!std::is_same_v<T, T>, "type has no JSON representation");
+					}
+				}
+
+			private:
+				void append(std::string_view str){ m_out.append(str); }
+
+				template<typename T>
+				void write_number(T val){
+					if constexpr(std::is_floating_point_v<T>){
+						if(!std::isfinite(val)){
+							append("null");
+							return;
+						}
+					}
+
+					char buf[64];
+					const auto res = std::to_chars(buf, buf + sizeof(buf), val);
+					m_out.append(buf, res.ptr);
+				}
+
+				template<typename Enum>
+				void write_enum(Enum val){
+					if constexpr(metapp::has_enum_info<Enum>){
+						const auto name = metapp::find_value_name(val);
+						if(!name.empty()){
+							write_json_string(m_out, name);
+							return;
+						}
+					}
+
+					// values without a name, like combined flags, are written as numbers
+					write_number(static_cast<std::underlying_type_t<Enum>>(val));
+				}
+
+				template<typename Range>
+				void write_range(const Range &range){
+					m_out.push_back('[');
+
+					bool first = true;
+					for(auto &&elem : range){
+						if(!first) m_out.push_back(',');
+						first = false;
+						write(elem);
+					}
+
+					m_out.push_back(']');
+				}
+
+				template<typename Class, std::size_t ... Is>
+				void write_class(const Class &cls, std::index_sequence<Is...>){
+					using members = metapp::members<Class>;
+
+					if(m_layout == json_layout::compact){
+						m_out.push_back('{');
+						bool first = true;
+						(write_compact_member<metapp::get_t<members, Is>>(cls, first), ...);
+						m_out.push_back('}');
+					}
+					else{
+						append("{\"");
+						append(metapp::type_name<Class>);
+						append("\":[");
+						bool first = true;
+						(write_verbose_member<metapp::get_t<members, Is>>(cls, first), ...);
+						append("]}");
+					}
+				}
+
+				template<typename Member, typename Class>
+				void write_compact_member(const Class &cls, bool &first){
+					if constexpr(Member::is_accessable){
+						if(!first) m_out.push_back(',');
+						first = false;
+
+						m_out.push_back('"');
+						append(Member::name);
+						append("\":");
+						write(Member::get(cls));
+					}
+				}
+
+				template<typename Member, typename Class>
+				void write_verbose_member(const Class &cls, bool &first){
+					if constexpr(Member::is_accessable){
+						using member_type = std::decay_t<typename Member::type>;
+
+						if(!first) m_out.push_back(',');
+						first = false;
+
+						append("{\"member\":{\"name\":\"");
+						append(Member::name);
+						append("\",\"type\":\"");
+						append(metapp::type_name<typename Member::type>);
+						append("\",\"value\":");
+
+						// scalars keep the quoted form of the original verbose layout, bools as "1" or "0"
+						if constexpr(std::is_same_v<member_type, bool>){
+							append(Member::get(cls) ? "\"1\"" : "\"0\"");
+						}
+						else if constexpr(is_json_char<member_type>){
+							const char c = static_cast<char>(Member::get(cls));
+							write_json_string(m_out, std::string_view(&c, 1));
+						}
+						else if constexpr(std::is_arithmetic_v<member_type>){
+							m_out.push_back('"');
+							write(Member::get(cls));
+							m_out.push_back('"');
+						}
+						else{
+							write(Member::get(cls));
+						}
+
+						append("}}");
+					}
+				}
+
+				fmt::memory_buffer &m_out;
+				json_layout m_layout;
+		};
+	}
+
+	/**
+	 * @brief Append the JSON representation of a value to a buffer.
+	 *
+	 * Numbers use their shortest round-trip form, enums are written by name and reflected classes,
+	 * containers and optionals are written recursively.
+	 */
+	template<typename T>
+	void to_json(fmt::memory_buffer &out, const T &val, json_layout layout = json_layout::verbose){
+		detail::json_writer(out, layout).write(val);
+	}
+
+	/**
+	 * @brief Get the JSON representation of a value.
+	 * @see to_json(fmt::memory_buffer&, const T&, json_layout)
+	 */
+	template<typename T>
+	std::string to_json(const T &val, json_layout layout = json_layout::verbose){
+		fmt::memory_buffer out;
+		to_json(out, val, layout);
+		return fmt::to_string(out);
+	}
+
+	namespace detail{
+		class json_reader{
+			public:
+				explicit json_reader(std::string_view json) noexcept
+					: m_begin(json.data()), m_it(m_begin), m_end(m_begin + json.size()){}
+
+				std::size_t offset() const noexcept{ return m_it - m_begin; }
+
+				bool at_end() noexcept{
+					skip_whitespace();
+					return m_it == m_end;
+				}
+
+				bool peek(char c) noexcept{
+					skip_whitespace();
+					return m_it != m_end && *m_it == c;
+				}
+
+				bool consume(char c) noexcept{
+					if(!peek(c)) return false;
+					++m_it;
+					return true;
+				}
+
+				bool consume(std::string_view literal) noexcept{
+					skip_whitespace();
+					if(std::size_t(m_end - m_it) < literal.size() || std::string_view(m_it, literal.size()) != literal) return false;
+					m_it += literal.size();
+					return true;
+				}
+
+				// the raw text of a string, escapes are left in place so keys can be matched without copying
+				bool read_raw_string(std::string_view &out) noexcept{
+					if(!consume('"')) return false;
+
+					const char *begin = m_it;
+
+					while(true){
+						m_it += json_plain_prefix(m_it, m_end - m_it);
+						if(m_it == m_end) return false;
+
+						if(*m_it == '"') break;
+						else if(*m_it != '\\' || ++m_it == m_end) return false;
+
+						++m_it;
+					}
+
+					out = std::string_view(begin, m_it - begin);
+					++m_it;
+					return true;
+				}
+
+				template<typename Char, typename Traits, typename Alloc>
+				bool read_string(std::basic_string<Char, Traits, Alloc> &out){
+					std::string_view raw;
+					if(!read_raw_string(raw)) return false;
+
+					out.clear();
+
+					while(!raw.empty()){
+						const auto escape = raw.find('\\');
+						out.append(raw.data(), std::min(escape, raw.size()));
+
+						if(escape == std::string_view::npos) break;
+
+						raw.remove_prefix(escape + 1);
+
+						const char c = raw.front();
+						raw.remove_prefix(1);
+
+						switch(c){
+							case '"': case '\\': case '/': out.push_back(c); break;
+							case 'b': out.push_back('\b'); break;
+							case 'f': out.push_back('\f'); break;
+							case 'n': out.push_back('\n'); break;
+							case 'r': out.push_back('\r'); break;
+							case 't': out.push_back('\t'); break;
+							case 'u':{
+								std::uint32_t code;
+								if(!read_hex4(raw, code)) return false;
+
+								if(code >= 0xd800 && code < 0xdc00){
+									std::uint32_t low;
+									if(raw.size() < 2 || raw[0] != '\\' || raw[1] != 'u') return false;
+									raw.remove_prefix(2);
+									if(!read_hex4(raw, low) || low < 0xdc00 || low >= 0xe000) return false;
+									code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+								}
+
+								append_utf8(out, code);
+								break;
+							}
+							default: return false;
+						}
+					}
+
+					return true;
+				}
+
+				template<typename T>
+				bool read_number(T &out) noexcept{
+					// the verbose layout writes scalars as strings
+					const bool quoted = consume('"');
+
+					if constexpr(std::is_floating_point_v<T>){
+						// non-finite values are written as null
+						if(consume(std::string_view("null"))){
+							out = std::numeric_limits<T>::quiet_NaN();
+							return !quoted || consume('"');
+						}
+					}
+
+					skip_whitespace();
+					const auto res = std::from_chars(m_it, m_end, out);
+					if(res.ec != std::errc()) return false;
+					m_it = res.ptr;
+
+					return !quoted || consume('"');
+				}
+
+				// skip any value without validating its contents
+				bool skip_value() noexcept{
+					skip_whitespace();
+					if(m_it == m_end) return false;
+
+					std::string_view str;
+
+					if(*m_it == '"'){
+						return read_raw_string(str);
+					}
+					else if(*m_it == '{' || *m_it == '['){
+						std::size_t depth = 0;
+
+						while(m_it != m_end){
+							const char c = *m_it;
+
+							if(c == '"'){
+								if(!read_raw_string(str)) return false;
+								continue;
+							}
+							else if(c == '{' || c == '['){
+								++depth;
+							}
+							else if((c == '}' || c == ']') && --depth == 0){
+								++m_it;
+								return true;
+							}
+
+							++m_it;
+						}
+
+						return false;
+					}
+					else{
+						const char *begin = m_it;
+						while(m_it != m_end && !std::strchr(",}] \t\r\n", *m_it)) ++m_it;
+						return m_it != begin;
+					}
+				}
+
+			private:
+				void skip_whitespace() noexcept{
+					while(m_it != m_end && (*m_it == ' ' || *m_it == '\n' || *m_it == '\r' || *m_it == '\t')) ++m_it;
+				}
+
+				static bool read_hex4(std::string_view &str, std::uint32_t &out) noexcept{
+					if(str.size() < 4) return false;
+
+					const auto res = std::from_chars(str.data(), str.data() + 4, out, 16);
+					if(res.ec != std::errc() || res.ptr != str.data() + 4) return false;
+
+					str.remove_prefix(4);
+					return true;
+				}
+
+				template<typename String>
+				static void append_utf8(String &out, std::uint32_t code){
+					if(code < 0x80){
+						out.push_back(static_cast<char>(code));
+					}
+					else if(code < 0x800){
+						out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+						out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+					else if(code < 0x10000){
+						out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+						out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+						out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+					else{
+						out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+						out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+						out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+						out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+				}
+
+				const char *m_begin, *m_it, *m_end;
+		};
+
+		constexpr std::uint64_t json_key_hash(std::string_view key, std::uint64_t seed) noexcept{
+			std::uint64_t hash = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+
+			for(const char c : key){
+				hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+			}
+
+			return hash ^ (hash >> 32);
+		}
+
+		struct json_key_params{
+			std::size_t size;
+			std::uint64_t seed;
+		};
+
+		// find a table size and seed that give every name its own slot
+		template<std::size_t N>
+		constexpr json_key_params find_json_key_params(const std::array<std::string_view, N> &names) noexcept{
+			std::size_t size = 8;
+			while(size < N * 8) size *= 2;
+
+			for(;; size *= 2){
+				for(std::uint64_t seed = 0; seed < 64; seed++){
+					std::array<std::uint64_t, N> slots{};
+					bool unique = true;
+
+					for(std::size_t i = 0; i < N && unique; i++){
+						slots[i] = json_key_hash(names[i], seed) & (size - 1);
+
+						for(std::size_t j = 0; j < i; j++){
+							if(slots[j] == slots[i]){
+								unique = false;
+								break;
+							}
+						}
+					}
+
+					if(unique) return { size, seed };
+				}
+			}
+		}
+
+		template<std::size_t Size, std::size_t N>
+		constexpr std::array<std::size_t, Size> make_json_key_slots(const std::array<std::string_view, N> &names, std::uint64_t seed) noexcept{
+			std::array<std::size_t, Size> ret{};
+
+			for(std::size_t i = 0; i < N; i++){
+				ret[json_key_hash(names[i], seed) & (Size - 1)] = i + 1;
+			}
+
+			return ret;
+		}
+
+		template<typename T, typename = void>
+		struct json_parser{
+			static_assert(!std::is_same_v<T, T>, "type has no JSON representation");
+		};
+
+		template<typename T>
+		bool read_json(T &val, json_reader &r){
+			return json_parser<T>::read(val, r);
+		}
+
+		template<>
+		struct json_parser<bool>{
+			static bool read(bool &val, json_reader &r){
+				if(r.consume(std::string_view("true"))) val = true;
+				else if(r.consume(std::string_view("false"))) val = false;
+				else return false;
+				return true;
+			}
+		};
+
+		template<typename T>
+		struct json_parser<T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>{
+			static bool read(T &val, json_reader &r){
+				return r.read_number(val);
+			}
+		};
+
+		template<typename Enum, typename ... Values>
+		constexpr bool enum_value_by_name(std::string_view name, Enum &val, metapp::types<Values...>) noexcept{
+			return ((Values::name == name ? (val = static_cast<Enum>(Values::value), true) : false) || ...);
+		}
+
+		template<typename Enum>
+		struct json_parser<Enum, std::enable_if_t<std::is_enum_v<Enum>>>{
+			static bool read(Enum &val, json_reader &r){
+				if constexpr(metapp::has_enum_info<Enum>){
+					std::string_view name;
+					if(r.peek('"') && r.read_raw_string(name)){
+						return enum_value_by_name(name, val, metapp::enum_values<Enum>{});
+					}
+				}
+
+				std::underlying_type_t<Enum> num;
+				if(!r.read_number(num)) return false;
+				val = static_cast<Enum>(num);
+				return true;
+			}
+		};
+
+		template<typename Char, typename Traits, typename Alloc>
+		struct json_parser<std::basic_string<Char, Traits, Alloc>, std::enable_if_t<std::is_same_v<Char, char>>>{
+			static bool read(std::basic_string<Char, Traits, Alloc> &val, json_reader &r){
+				return r.read_string(val);
+			}
+		};
+
+		template<typename T>
+		struct json_parser<std::optional<T>>{
+			static bool read(std::optional<T> &val, json_reader &r){
+				if(r.consume(std::string_view("null"))){
+					val.reset();
+					return true;
+				}
+
+				return read_json(val.emplace(), r);
+			}
+		};
+
+		template<typename T, typename Alloc>
+		struct json_parser<std::vector<T, Alloc>, std::enable_if_t<!std::is_same_v<T, bool>>>{
+			static bool read(std::vector<T, Alloc> &val, json_reader &r){
+				if(!r.consume('[')) return false;
+
+				val.clear();
+				if(r.consume(']')) return true;
+
+				do{
+					if(!read_json(val.emplace_back(), r)) return false;
+				} while(r.consume(','));
+
+				return r.consume(']');
+			}
+		};
+
+		template<typename T, std::size_t N>
+		struct json_parser<std::array<T, N>>{
+			static bool read(std::array<T, N> &val, json_reader &r){
+				if(!r.consume('[')) return false;
+
+				for(std::size_t i = 0; i < N; i++){
+					if((i > 0 && !r.consume(',')) || !read_json(val[i], r)) return false;
+				}
+
+				return r.consume(']');
+			}
+		};
+
+		template<typename Class, typename Members = metapp::members<Class>>
+		struct json_class_parser;
+
+		template<typename Class, typename ... Members>
+		struct json_class_parser<Class, metapp::types<Members...>>{
+			static constexpr std::array<std::string_view, sizeof...(Members)> names = { Members::name... };
+
+			static constexpr json_key_params params = find_json_key_params(names);
+			static constexpr auto slots = make_json_key_slots<params.size>(names, params.seed);
+
+			// a member with the same name as the class would make the verbose layout ambiguous
+			static constexpr bool accepts_verbose = ((Members::name != metapp::type_name<Class>) && ...);
+
+			template<typename Member>
+			static bool read_member(Class &cls, json_reader &r){
+				if constexpr(Member::is_accessable){
+					return read_json(Member::get(cls), r);
+				}
+				else{
+					return r.skip_value();
+				}
+			}
+
+			// the verbose layout writes bools as "1" or "0" and characters as one character strings
+			template<typename Member>
+			static bool read_verbose_member_value(Class &cls, json_reader &r){
+				if constexpr(Member::is_accessable){
+					using member_type = std::decay_t<typename Member::type>;
+
+					if constexpr(std::is_same_v<member_type, bool>){
+						if(r.consume(std::string_view("\"1\""))) Member::get(cls) = true;
+						else if(r.consume(std::string_view("\"0\""))) Member::get(cls) = false;
+						else return false;
+						return true;
+					}
+					else if constexpr(is_json_char<member_type>){
+						std::string str;
+						if(!r.read_string(str) || str.size() != 1) return false;
+						Member::get(cls) = static_cast<member_type>(str[0]);
+						return true;
+					}
+					else{
+						return read_member<Member>(cls, r);
+					}
+				}
+				else{
+					return r.skip_value();
+				}
+			}
+
+			using read_fn = bool(*)(Class&, json_reader&);
+			static constexpr read_fn readers[] = { &read_member<Members>..., nullptr };
+			static constexpr read_fn verbose_readers[] = { &read_verbose_member_value<Members>..., nullptr };
+
+			// keys are matched raw, unknown keys are skipped
+			static bool read_key(Class &cls, std::string_view key, json_reader &r, const read_fn *fns = readers){
+				const auto slot = slots[json_key_hash(key, params.seed) & (params.size - 1)];
+
+				if(!slot || names[slot - 1] != key){
+					return r.skip_value();
+				}
+
+				return fns[slot - 1](cls, r);
+			}
+
+			// {"member":{"name":"m_0","type":"int","value":"69"}}
+			static bool read_verbose_member(Class &cls, json_reader &r){
+				std::string_view key, name;
+
+				if(
+					!r.consume('{') || !r.read_raw_string(key) || key != "member" ||
+					!r.consume(':') || !r.consume('{')
+				){
+					return false;
+				}
+
+				do{
+					if(!r.read_raw_string(key) || !r.consume(':')) return false;
+
+					if(key == "name"){
+						if(!r.read_raw_string(name)) return false;
+					}
+					else if(key == "value" && !name.empty()){
+						if(!read_key(cls, name, r, verbose_readers)) return false;
+					}
+					else if(!r.skip_value()){
+						return false;
+					}
+				} while(r.consume(','));
+
+				return r.consume('}') && r.consume('}');
+			}
+
+			static bool read_verbose(Class &cls, json_reader &r){
+				if(!r.consume('[')) return false;
+				if(r.consume(']')) return true;
+
+				do{
+					if(!read_verbose_member(cls, r)) return false;
+				} while(r.consume(','));
+
+				return r.consume(']');
+			}
+
+			static bool read(Class &cls, json_reader &r){
+				if(!r.consume('{')) return false;
+				if(r.consume('}')) return true;
+
+				std::string_view key;
+				if(!r.read_raw_string(key) || !r.consume(':')) return false;
+
+				if(accepts_verbose && key == metapp::type_name<Class>){
+					return read_verbose(cls, r) && r.consume('}');
+				}
+
+				while(true){
+					if(!read_key(cls, key, r)) return false;
+					if(r.consume('}')) return true;
+					if(!r.consume(',') || !r.read_raw_string(key) || !r.consume(':')) return false;
+				}
+			}
+		};
+
+		template<typename Class>
+		struct json_parser<Class, std::enable_if_t<metapp::has_info<Class>>>: json_class_parser<Class>{};
+	}
+
+	/**
+	 * @brief Fill a value in place from JSON in either `json_layout`.
+	 *
+	 * Object keys are matched to members through a perfect hash built at compile time, members
+	 * missing from the input keep their value and unknown keys are skipped.
+	 *
+	 * @returns `false` if the input is malformed or doesn't match the type
+	 */
+	template<typename T>
+	bool from_json(std::string_view json, T &out){
+		detail::json_reader reader(json);
+		return detail::read_json(out, reader) && reader.at_end();
+	}
+
+	/**
+	 * @brief Parse a value from JSON in either `json_layout`.
+	 * @throws std::runtime_error if the input is malformed or doesn't match the type
+	 */
+	template<typename T>
+	T from_json(std::string_view json){
+		T ret{};
+
+		detail::json_reader reader(json);
+		if(!detail::read_json(ret, reader) || !reader.at_end()){
+			throw std::runtime_error(fmt::format("Invalid JSON for '{}' at offset {}", metapp::type_name<T>, reader.offset()));
+		}
+
+		return ret;
 	}
 }
 
@@ -9,10 +9,26 @@
 #include "boost/dll/shared_library.hpp"
 #include "boost/dll/runtime_symbol_info.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
 #ifdef __linux__
 #include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #elif defined(_WIN32)
 #include <windows.h>
+#include <psapi.h>
 #else
 #error "Unsupported operating system"
 #endif
@@ -48,6 +64,272 @@ namespace pluginpp::detail{
 #endif
 	}
 
+	// only accept symbols defined by the library itself, not by one of its dependencies
+	static void *get_own_symbol(lib_handle lib, const char *name){
+#ifdef __linux__
+		void *sym = dlsym(lib, name);
+		if(!sym) return nullptr;
+
+		struct link_map *lib_map = nullptr, *sym_map = nullptr;
+		Dl_info info;
+
+		if(dlinfo(lib, RTLD_DI_LINKMAP, &lib_map) != 0 || !dladdr1(sym, &info, reinterpret_cast<void**>(&sym_map), RTLD_DL_LINKMAP)){
+			return nullptr;
+		}
+
+		return lib_map == sym_map ? sym : nullptr;
+#else
+		return get_symbol(lib, name);
+#endif
+	}
+
+	// what we learn about a library from its file, before opening it
+	struct library_image{
+		std::string soname;
+		std::vector<std::string> needed;
+		bool has_entry_point = false;
+	};
+
+	using file_mapping = std::shared_ptr<const unsigned char>;
+
+	// map a whole file read only, optionally asking the kernel to read it ahead
+	static file_mapping map_file(const std::filesystem::path &path, std::size_t &size, bool prefault = false){
+#ifdef __linux__
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd < 0) return nullptr;
+
+		struct stat st;
+		if(fstat(fd, &st) != 0 || st.st_size <= 0){
+			close(fd);
+			return nullptr;
+		}
+
+		const auto file_size = std::size_t(st.st_size);
+
+		void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if(mapping == MAP_FAILED) return nullptr;
+
+		if(prefault){
+			madvise(mapping, file_size, MADV_WILLNEED);
+		}
+
+		size = file_size;
+
+		return file_mapping(
+			static_cast<const unsigned char*>(mapping),
+			[file_size](const unsigned char *p){ munmap(const_cast<unsigned char*>(p), file_size); }
+		);
+#else
+		(void)prefault;
+
+		std::error_code ec;
+		const auto file_size = std::filesystem::file_size(path, ec);
+		if(ec || file_size == 0) return nullptr;
+
+		auto buf = std::make_unique<unsigned char[]>(file_size);
+
+		std::ifstream file(path, std::ios::binary);
+		if(!file.read(reinterpret_cast<char*>(buf.get()), std::streamsize(file_size))) return nullptr;
+
+		size = std::size_t(file_size);
+		return file_mapping(buf.release(), std::default_delete<const unsigned char[]>());
+#endif
+	}
+
+#ifdef __linux__
+	// bounds checked access to the section headers of an elf image
+	template<typename Ehdr, typename Shdr>
+	class elf_sections{
+		public:
+			elf_sections(const unsigned char *data, std::size_t size) noexcept
+				: m_data(data), m_size(size)
+			{
+				if(size < sizeof(m_ehdr)) return;
+
+				std::memcpy(&m_ehdr, data, sizeof(m_ehdr));
+
+				m_valid =
+					m_ehdr.e_shentsize == sizeof(Shdr) &&
+					m_ehdr.e_shoff <= size &&
+					m_ehdr.e_shnum <= (size - m_ehdr.e_shoff) / sizeof(Shdr);
+			}
+
+			bool is_valid() const noexcept{ return m_valid; }
+
+			std::size_t size() const noexcept{ return m_valid ? m_ehdr.e_shnum : 0; }
+
+			bool get(std::size_t idx, Shdr &out) const noexcept{
+				if(idx >= size()) return false;
+				std::memcpy(&out, m_data + m_ehdr.e_shoff + (idx * sizeof(Shdr)), sizeof(Shdr));
+				return out.sh_type != SHT_NOBITS && out.sh_offset <= m_size && out.sh_size <= m_size - out.sh_offset;
+			}
+
+			std::string_view string_at(const Shdr &strtab, std::size_t off) const noexcept{
+				if(off >= strtab.sh_size) return {};
+				auto str = reinterpret_cast<const char*>(m_data + strtab.sh_offset + off);
+				return std::string_view(str, strnlen(str, strtab.sh_size - off));
+			}
+
+			std::optional<Shdr> find(std::string_view name) const noexcept{
+				Shdr names, shdr;
+				if(!get(m_ehdr.e_shstrndx, names)) return std::nullopt;
+
+				for(std::size_t i = 0; i < size(); i++){
+					if(get(i, shdr) && string_at(names, shdr.sh_name) == name){
+						return shdr;
+					}
+				}
+
+				return std::nullopt;
+			}
+
+		private:
+			const unsigned char *m_data;
+			std::size_t m_size;
+			Ehdr m_ehdr;
+			bool m_valid = false;
+	};
+
+	template<typename Ehdr, typename Shdr, typename Dyn, typename Sym>
+	static bool read_elf(const unsigned char *data, std::size_t size, library_image &img){
+		const elf_sections<Ehdr, Shdr> sections(data, size);
+		if(!sections.is_valid()) return false;
+
+		for(std::size_t i = 0; i < sections.size(); i++){
+			Shdr shdr, strtab;
+			if(!sections.get(i, shdr) || !sections.get(shdr.sh_link, strtab)) continue;
+
+			auto entries = data + shdr.sh_offset;
+
+			if(shdr.sh_type == SHT_DYNAMIC){
+				for(std::size_t j = 0; j < shdr.sh_size / sizeof(Dyn); j++){
+					Dyn dyn;
+					std::memcpy(&dyn, entries + (j * sizeof(Dyn)), sizeof(Dyn));
+
+					if(dyn.d_tag == DT_NULL){
+						break;
+					}
+					else if(dyn.d_tag == DT_NEEDED){
+						img.needed.emplace_back(sections.string_at(strtab, dyn.d_un.d_val));
+					}
+					else if(dyn.d_tag == DT_SONAME){
+						img.soname = sections.string_at(strtab, dyn.d_un.d_val);
+					}
+				}
+			}
+			else if(shdr.sh_type == SHT_DYNSYM){
+				for(std::size_t j = 0; j < shdr.sh_size / sizeof(Sym); j++){
+					Sym sym;
+					std::memcpy(&sym, entries + (j * sizeof(Sym)), sizeof(Sym));
+
+					if(sym.st_shndx != SHN_UNDEF && sections.string_at(strtab, sym.st_name) == refl::detail::library_exports_symbol){
+						img.has_entry_point = true;
+						break;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	static int elf_class(const unsigned char *data, std::size_t size) noexcept{
+		if(size < EI_NIDENT || std::memcmp(data, ELFMAG, SELFMAG) != 0) return ELFCLASSNONE;
+		return data[EI_CLASS];
+	}
+#endif
+
+	// map the file, ask the kernel to read it ahead for the loader and pull out the dynamic section
+	static bool inspect_library(const std::filesystem::path &path, library_image &img){
+#ifdef __linux__
+		std::size_t size = 0;
+
+		auto data = map_file(path, size, true);
+		if(!data) return false;
+
+		switch(elf_class(data.get(), size)){
+			case ELFCLASS64: return read_elf<Elf64_Ehdr, Elf64_Shdr, Elf64_Dyn, Elf64_Sym>(data.get(), size, img);
+			case ELFCLASS32: return read_elf<Elf32_Ehdr, Elf32_Shdr, Elf32_Dyn, Elf32_Sym>(data.get(), size, img);
+			default: return false;
+		}
+#else
+		(void)path;
+		(void)img;
+		return true;
+#endif
+	}
+
+	// offset and size of the generated manifest section within a mapped library
+	static std::optional<std::pair<std::size_t, std::size_t>> find_manifest_section(const unsigned char *data, std::size_t size){
+#ifdef __linux__
+		const auto find = [&](auto sections) -> std::optional<std::pair<std::size_t, std::size_t>>{
+			auto shdr = sections.find(refl::detail::manifest_section_name);
+			if(!shdr) return std::nullopt;
+			return std::make_pair(std::size_t(shdr->sh_offset), std::size_t(shdr->sh_size));
+		};
+
+		switch(elf_class(data, size)){
+			case ELFCLASS64: return find(elf_sections<Elf64_Ehdr, Elf64_Shdr>(data, size));
+			case ELFCLASS32: return find(elf_sections<Elf32_Ehdr, Elf32_Shdr>(data, size));
+			default: return std::nullopt;
+		}
+#else
+		(void)data;
+		(void)size;
+		return std::nullopt;
+#endif
+	}
+
+	using segment_list = std::vector<std::pair<const void*, const void*>>;
+
+	// address ranges a library is mapped to
+	static segment_list library_segments(lib_handle lib){
+		segment_list ret;
+
+#ifdef __linux__
+		struct search_data{
+			const struct link_map *map;
+			std::vector<std::pair<const void*, const void*>> *segments;
+		};
+
+		struct link_map *map = nullptr;
+		if(dlinfo(lib, RTLD_DI_LINKMAP, &map) != 0) return ret;
+
+		search_data data{ map, &ret };
+
+		dl_iterate_phdr(
+			[](struct dl_phdr_info *info, std::size_t, void *user) -> int{
+				auto data = static_cast<search_data*>(user);
+
+				if(info->dlpi_addr != data->map->l_addr || std::strcmp(info->dlpi_name, data->map->l_name) != 0){
+					return 0;
+				}
+
+				for(std::size_t i = 0; i < info->dlpi_phnum; i++){
+					const auto &phdr = info->dlpi_phdr[i];
+					if(phdr.p_type != PT_LOAD) continue;
+
+					auto begin = reinterpret_cast<const char*>(info->dlpi_addr + phdr.p_vaddr);
+					data->segments->emplace_back(begin, begin + phdr.p_memsz);
+				}
+
+				return 1;
+			},
+			&data
+		);
+#else
+		MODULEINFO info;
+		if(GetModuleInformation(GetCurrentProcess(), lib, &info, sizeof(info))){
+			auto begin = static_cast<const char*>(info.lpBaseOfDll);
+			ret.emplace_back(begin, begin + info.SizeOfImage);
+		}
+#endif
+
+		return ret;
+	}
+
 	static const char *get_error(){
 #ifdef __linux__
 		return dlerror();
@@ -82,60 +364,103 @@ namespace {
 		print_fn(msg);
 	}
 
+	static std::atomic<layout_check> layout_check_policy = layout_check::reject;
+
 	class self_t{};
+	class deferred_import_t{};
+
+	bool is_plugin_file(const fs::path &path){
+		if(!fs::exists(path)){
+			print_error("Plugin path '{}' does not exist", path.u8string());
+			return false;
+		}
+		else if(!fs::is_regular_file(path)){
+			print_error("Plugin path '{}' is not a file", path.u8string());
+			return false;
+		}
+
+		return true;
+	}
+
+	// lazily loaded symbol table and demangled name cache
+	struct symbol_cache{
+		std::once_flag loaded;
+		std::vector<std::string> symbols;
+
+		std::mutex demangled_mutex;
+		std::unordered_map<std::string, std::string> demangled;
+	};
 
 	class dynamic_library: public library{
 		public:
 			explicit dynamic_library(self_t)
 				: m_handle(detail::load_library(nullptr))
+				, m_path(dll::program_location())
 			{
 				if(!m_handle){
 					auto msg = fmt::format("Error in load_library: {}", detail::get_error());
 					throw std::runtime_error(msg);
 				}
 
-				auto info = dll::library_info(dll::program_location());
-
-				m_symbols = info.symbols();
+				import();
+			}
 
-				import_entities();
+			explicit dynamic_library(const fs::path &path, std::optional<std::vector<std::string>> symbols = std::nullopt)
+				: dynamic_library(path, deferred_import_t{}, std::move(symbols))
+			{
+				try{
+					import();
+				}
+				catch(...){
+					// the library registered its tables when it was opened
+					deregister();
+					throw;
+				}
 			}
 
-			explicit dynamic_library(const fs::path &path){
-				auto path_utf8 = path.u8string();
+			// open the library without registering anything, import() must be called before use
+			dynamic_library(const fs::path &path, deferred_import_t, std::optional<std::vector<std::string>> symbols = std::nullopt)
+				: m_path(path)
+			{
+				if(symbols){
+					std::call_once(m_cache->loaded, [&]{ m_cache->symbols = std::move(*symbols); });
+				}
 
 				m_handle = detail::load_library(path.u8string().c_str());
 				if(!m_handle){
 					auto msg = fmt::format("Error in load_library: {}", detail::get_error());
 					throw std::runtime_error(msg);
 				}
-
-				auto info = dll::library_info(path);
-
-				m_symbols = info.symbols();
-
-				import_entities();
 			}
 
 			dynamic_library(const dynamic_library&) = delete;
 
 			dynamic_library(dynamic_library &&other) noexcept
 				: m_handle(std::exchange(other.m_handle, nullptr))
-				, m_symbols(std::move(other.m_symbols))
+				, m_path(std::move(other.m_path))
+				, m_owns_file(std::exchange(other.m_owns_file, false))
+				, m_cache(std::move(other.m_cache))
 				, m_types(std::move(other.m_types))
+				, m_fns(std::move(other.m_fns))
 			{}
 
 			~dynamic_library(){
 				reset();
+				remove_owned_file();
 			}
 
 			dynamic_library &operator=(const dynamic_library&) = delete;
 
 			dynamic_library &operator=(dynamic_library &&other) noexcept{
 				if(this != &other){
-					m_symbols = std::move(other.m_symbols);
-					m_types = std::move(other.m_types);
 					reset(std::exchange(other.m_handle, nullptr));
+					remove_owned_file();
+
+					m_path = std::move(other.m_path);
+					m_owns_file = std::exchange(other.m_owns_file, false);
+					m_cache = std::move(other.m_cache);
+					m_types = std::move(other.m_types);
+					m_fns = std::move(other.m_fns);
 				}
 
 				return *this;
@@ -143,12 +468,63 @@ namespace {
 
 			bool is_valid() const noexcept{ return !!m_handle; }
 
+			// delete the library file once it is closed, for private copies made by reload
+			void own_file() noexcept{ m_owns_file = true; }
+
+			void import(){
+				collect();
+				register_entities();
+			}
+
+			// call the library's export functions, which must never run under the registry lock
+			// layouts are compared against everything but this library and the one it `replaces`
+			void collect(const dynamic_library *replaces = nullptr){
+				auto excluded = detail::library_segments(m_handle);
+
+				if(replaces){
+					auto replaced = detail::library_segments(replaces->m_handle);
+					excluded.insert(excluded.end(), replaced.begin(), replaced.end());
+				}
+
+				if(!collect_tables(excluded)){
+					collect_entities(excluded);
+				}
+			}
+
+			void register_entities() const{
+				for(auto type : m_types){
+					refl::detail::register_type(type);
+				}
+
+				for(auto fn : m_fns){
+					refl::detail::register_function(fn);
+				}
+			}
+
+			// drop everything the library put in the registry, including entities it instantiated for other libraries' types
+			void deregister() const{
+				refl::detail::registry_lock lock;
+
+				for(auto &&segment : detail::library_segments(m_handle)){
+					refl::detail::deregister_range(segment.first, segment.second);
+				}
+			}
+
 			std::string demangle(const std::string &symbol_name) const noexcept override{
-				return boost::core::demangle(symbol_name.c_str());
+				std::lock_guard lock(m_cache->demangled_mutex);
+
+				auto res = m_cache->demangled.find(symbol_name);
+				if(res != m_cache->demangled.end()){
+					return res->second;
+				}
+
+				auto demangled = boost::core::demangle(symbol_name.c_str());
+				return m_cache->demangled.try_emplace(symbol_name, std::move(demangled)).first->second;
 			}
 
 			const std::vector<std::string> &symbols() const noexcept override{
-				return m_symbols;
+				std::call_once(m_cache->loaded, [this]{ load_symbols(); });
+				return m_cache->symbols;
 			}
 
 			const std::vector<reflpp::type_info> &exported_types() const noexcept override{
@@ -171,8 +547,93 @@ namespace {
 			}
 
 		private:
-			void import_entities(){
-				for(auto &&sym : m_symbols){
+			void load_symbols() const noexcept{
+				try{
+					m_cache->symbols = dll::library_info(m_path).symbols();
+				}
+				catch(const std::exception &err){
+					print_error("Error reading symbols of '{}': {}", m_path.u8string(), err.what());
+				}
+			}
+
+			// collect everything through the generated entry point and the tables registered when the library was opened,
+			// without touching the symbol table
+			bool collect_tables(const detail::segment_list &excluded){
+				auto entry = reinterpret_cast<refl::detail::library_exports_fn>(
+					detail::get_own_symbol(m_handle, refl::detail::library_exports_symbol)
+				);
+
+				std::vector<refl::detail::export_tables> tables;
+
+				if(entry){
+					auto exports = entry();
+					tables.reserve(exports->num_tables);
+
+					for(std::size_t i = 0; i < exports->num_tables; i++){
+						tables.emplace_back(*exports->tables[i]);
+					}
+				}
+
+				// reflected static libraries linked into this one registered their tables when it was opened,
+				// a library made only of those has no entry point and its generated exports aren't in the symbol table
+				for(auto &&segment : detail::library_segments(m_handle)){
+					for(auto &&table : refl::detail::registered_tables(segment.first, segment.second)){
+						const bool listed = std::any_of(tables.begin(), tables.end(), [&table](auto &&other){
+							return (table.types && table.types == other.types) || (table.functions && table.functions == other.functions);
+						});
+
+						if(!listed){
+							tables.emplace_back(table);
+						}
+					}
+				}
+
+				// libraries without generated tables are only found by their symbols
+				if(!entry && tables.empty()) return false;
+
+				// checked before anything is imported
+				for(auto &&table : tables){
+					for(std::size_t j = 0; j < table.num_types; j++){
+						check_layout(table.types[j].name, table.types[j].id, table.types[j].layout_fingerprint, excluded);
+					}
+				}
+
+				for(auto &&table : tables){
+					for(std::size_t j = 0; j < table.num_types; j++){
+						if(auto type = table.types[j].fn()){
+							m_types.emplace_back(type);
+						}
+					}
+
+					for(std::size_t j = 0; j < table.num_functions; j++){
+						if(auto fn = table.functions[j].fn()){
+							m_fns.emplace_back(fn);
+						}
+					}
+				}
+
+				return true;
+			}
+
+			// one compare against the type registered with the same id by the program or any other library
+			void check_layout(std::string_view name, std::uint64_t id, std::uint64_t fingerprint, const detail::segment_list &excluded) const{
+				const auto check = layout_check_policy.load(std::memory_order_relaxed);
+				if(check == layout_check::ignore || !fingerprint) return;
+
+				const auto registered = refl::detail::registered_layout_fingerprint(id, excluded);
+				if(!registered || registered == fingerprint) return;
+
+				auto msg = fmt::format("Layout of '{}' in '{}' differs from the registered type", name, m_path.u8string());
+
+				if(check == layout_check::reject){
+					throw std::runtime_error(msg);
+				}
+
+				print_error("{}", msg);
+			}
+
+			void collect_entities(const detail::segment_list &excluded){
+				for(auto &&sym : symbols()){
 					auto readable = demangle(sym);
 
 					constexpr std::string_view exportFnName = "reflpp::detail::function_export";
@@ -181,7 +642,7 @@ namespace {
 						auto ptr = get_symbol(sym);
 						auto f = reinterpret_cast<refl::detail::function_export_fn>(ptr);
 						assert(f);
-						auto fn = m_fns.emplace_back(f());
+						m_fns.emplace_back(f());
 						continue;
 					}
 
@@ -191,11 +652,16 @@ namespace {
 						auto ptr = get_symbol(sym);
 						auto f = reinterpret_cast<refl::detail::type_export_fn>(ptr);
 						assert(f);
-						auto type = m_types.emplace_back(f());
-						refl::detail::register_type(type);
+						m_types.emplace_back(f());
 						continue;
 					}
 				}
+
+				for(auto type : m_types){
+					if(auto cls = dynamic_cast<refl::class_info>(type)){
+						check_layout(cls->name(), cls->id(), cls->layout_fingerprint(), excluded);
+					}
+				}
 			}
 
 			void reset(detail::lib_handle handle = nullptr){
@@ -206,27 +672,353 @@ namespace {
 				}
 			}
 
-			detail::lib_handle m_handle;
-			std::vector<std::string> m_symbols;
+			void remove_owned_file() noexcept{
+				if(!std::exchange(m_owns_file, false)) return;
+
+				std::error_code ec;
+				if(!fs::remove(m_path, ec) && ec){
+					print_error("Error removing '{}': {}", m_path.u8string(), ec.message());
+				}
+			}
+
+			detail::lib_handle m_handle = nullptr;
+			fs::path m_path;
+			bool m_owns_file = false;
+			std::unique_ptr<symbol_cache> m_cache = std::make_unique<symbol_cache>();
 			std::vector<refl::type_info> m_types;
 			std::vector<refl::function_info> m_fns;
 	};
 
+	// readers publish the epoch they entered in,
+	// anything retired in a later epoch can be released once every earlier reader has left
+	class epoch_domain{
+		public:
+			struct record{
+				std::atomic<std::uint64_t> epoch = 0;
+				std::size_t depth = 0;
+			};
+
+			void add(record *rec){
+				std::lock_guard lock(m_mut);
+				m_records.emplace_back(rec);
+			}
+
+			void remove(record *rec){
+				std::lock_guard lock(m_mut);
+				m_records.erase(std::find(m_records.begin(), m_records.end(), rec));
+			}
+
+			void enter(record &rec) noexcept{
+				if(rec.depth++ == 0){
+					rec.epoch.store(m_epoch.load());
+				}
+			}
+
+			// returns whether the outermost guard was left
+			bool leave(record &rec) noexcept{
+				if(--rec.depth != 0) return false;
+
+				rec.epoch.store(0, std::memory_order_release);
+				return true;
+			}
+
+			std::uint64_t advance() noexcept{
+				return m_epoch.fetch_add(1) + 1;
+			}
+
+			std::uint64_t oldest_reader(){
+				std::lock_guard lock(m_mut);
+
+				std::uint64_t ret = UINT64_MAX;
+
+				for(auto rec : m_records){
+					const auto epoch = rec->epoch.load();
+					if(epoch != 0) ret = std::min(ret, epoch);
+				}
+
+				return ret;
+			}
+
+		private:
+			std::atomic<std::uint64_t> m_epoch = 1;
+			std::mutex m_mut;
+			std::vector<record*> m_records;
+	};
+
+	epoch_domain &epochs(){
+		static epoch_domain ret;
+		return ret;
+	}
+
+	epoch_domain::record &this_reader(){
+		struct thread_reader{
+			thread_reader(){ epochs().add(&record); }
+			~thread_reader(){ epochs().remove(&record); }
+
+			epoch_domain::record record;
+		};
+
+		thread_local thread_reader ret;
+		return ret.record;
+	}
+
 	class plugin_loader{
 		public:
-			plugin_loader(): m_self(self_t{}){}
+			using library_map = std::unordered_map<std::string, dynamic_library>;
+
+			plugin_loader() = default;
 
 			const dynamic_library *load(const fs::path &path){
-				if(!fs::exists(path)){
-					print_error("Plugin path '{}' does not exist", path.u8string());
+				if(!is_plugin_file(path)){
 					return nullptr;
 				}
-				else if(!fs::is_regular_file(path)){
-					print_error("Plugin path '{}' is not a file", path.u8string());
+
+				std::lock_guard lock(m_mut);
+
+				try{
+					return publish(fs::absolute(path));
+				}
+				catch(const std::exception &err){
+					print_error("Error loading plugin '{}': {}", path.u8string(), err.what());
+					return nullptr;
+				}
+			}
+
+			std::vector<const library*> load_all(const std::vector<fs::path> &paths, std::size_t num_threads){
+				struct pending{
+					fs::path path;
+					detail::library_image image;
+					std::optional<std::vector<std::string>> symbols;
+					bool ok = false;
+				};
+
+				std::vector<pending> items(paths.size());
+				std::atomic_size_t next_item = 0;
+
+				const auto inspect_items = [&]{
+					for(std::size_t i; (i = next_item++) < items.size();){
+						auto &item = items[i];
+
+						try{
+							if(!is_plugin_file(paths[i])) continue;
+
+							item.path = fs::absolute(paths[i]);
+							item.ok = detail::inspect_library(item.path, item.image);
+
+							if(!item.ok){
+								print_error("Plugin '{}' is not a valid shared library", item.path.u8string());
+							}
+							else if(!item.image.has_entry_point){
+								// imported through the symbol table, so read it now instead of during publish
+								item.symbols = dll::library_info(item.path).symbols();
+							}
+						}
+						catch(const std::exception &err){
+							item.ok = false;
+							print_error("Error inspecting plugin '{}': {}", paths[i].u8string(), err.what());
+						}
+					}
+				};
+
+				if(num_threads == 0){
+					num_threads = std::max(1u, std::thread::hardware_concurrency());
+				}
+
+				num_threads = std::min(num_threads, items.size());
+
+				std::vector<std::thread> workers;
+				workers.reserve(num_threads);
+
+				for(std::size_t i = 1; i < num_threads; i++){
+					workers.emplace_back(inspect_items);
+				}
+
+				inspect_items();
+
+				for(auto &&worker : workers){
+					worker.join();
+				}
+
+				// order plugins so each is published after the plugins it links against
+				std::unordered_map<std::string, std::size_t> by_name;
+
+				for(std::size_t i = 0; i < items.size(); i++){
+					if(!items[i].ok) continue;
+
+					by_name.try_emplace(items[i].path.filename().u8string(), i);
+
+					if(!items[i].image.soname.empty()){
+						by_name.try_emplace(items[i].image.soname, i);
+					}
+				}
+
+				std::vector<std::vector<std::size_t>> dependents(items.size());
+				std::vector<std::size_t> num_deps(items.size(), 0);
+
+				for(std::size_t i = 0; i < items.size(); i++){
+					if(!items[i].ok) continue;
+
+					for(auto &&needed : items[i].image.needed){
+						auto res = by_name.find(needed);
+						if(res != by_name.end() && res->second != i){
+							dependents[res->second].emplace_back(i);
+							++num_deps[i];
+						}
+					}
+				}
+
+				std::vector<std::size_t> order;
+				order.reserve(items.size());
+
+				for(std::size_t i = 0; i < items.size(); i++){
+					if(items[i].ok && num_deps[i] == 0){
+						order.emplace_back(i);
+					}
+				}
+
+				for(std::size_t i = 0; i < order.size(); i++){
+					for(auto dependent : dependents[order[i]]){
+						if(--num_deps[dependent] == 0){
+							order.emplace_back(dependent);
+						}
+					}
+				}
+
+				// dependency cycles can't be ordered, so load whatever is left as given
+				for(std::size_t i = 0; i < items.size(); i++){
+					if(items[i].ok && num_deps[i] != 0){
+						order.emplace_back(i);
+					}
+				}
+
+				std::vector<const library*> ret(items.size(), nullptr);
+
+				std::lock_guard lock(m_mut);
+
+				for(auto i : order){
+					try{
+						ret[i] = publish(items[i].path, std::move(items[i].symbols));
+					}
+					catch(const std::exception &err){
+						print_error("Error loading plugin '{}': {}", items[i].path.u8string(), err.what());
+					}
+				}
+
+				return ret;
+			}
+
+			const dynamic_library *self(){
+				std::call_once(m_self_flag, [this]{ m_self.emplace(self_t{}); });
+				return &*m_self;
+			}
+
+			const dynamic_library *reload(const fs::path &path){
+				if(!is_plugin_file(path)){
 					return nullptr;
 				}
 
 				auto abs_path = fs::absolute(path);
+
+				std::lock_guard lock(m_mut);
+
+				auto res = m_libraries.find(abs_path.u8string());
+				if(res == m_libraries.end()){
+					return publish(abs_path);
+				}
+
+				// the dynamic linker hands back the open library for any path it has seen, so open a private copy
+				auto copy_path = fs::temp_directory_path() / fmt::format(
+					"{}-{}-{}{}",
+					abs_path.stem().u8string(), static_cast<const void*>(this), ++m_generation, abs_path.extension().u8string()
+				);
+
+				// nothing the new library registers is seen until the old one is dropped, and nothing is left behind if it fails
+				refl::detail::registration_stage stage;
+				std::optional<dynamic_library> next;
+
+				try{
+					fs::copy_file(abs_path, copy_path, fs::copy_options::overwrite_existing);
+					next.emplace(copy_path, deferred_import_t{});
+					next->own_file();
+					next->collect(&res->second);
+				}
+				catch(const std::exception &err){
+					if(!next){
+						std::error_code ec;
+						fs::remove(copy_path, ec);
+					}
+
+					print_error("Error reloading plugin '{}': {}", abs_path.u8string(), err.what());
+					return nullptr;
+				}
+
+				{
+					refl::detail::registry_lock registry;
+
+					res->second.deregister();
+					stage.publish();
+					next->register_entities();
+				}
+
+				retire(m_libraries.extract(res));
+
+				auto emplace_res = m_libraries.try_emplace(abs_path.u8string(), std::move(*next));
+				return &emplace_res.first->second;
+			}
+
+			bool unload(const library *lib){
+				std::lock_guard lock(m_mut);
+
+				auto res = std::find_if(m_libraries.begin(), m_libraries.end(), [lib](auto &&lib_p){ return &lib_p.second == lib; });
+				if(res == m_libraries.end()){
+					return false;
+				}
+
+				res->second.deregister();
+				retire(m_libraries.extract(res));
+				return true;
+			}
+
+			// close retired libraries that no reader can still be using
+			void collect(){
+				if(m_num_retired.load(std::memory_order_acquire) == 0) return;
+
+				std::vector<library_map::node_type> released;
+
+				{
+					std::lock_guard lock(m_retired_mut);
+
+					const auto oldest = epochs().oldest_reader();
+
+					for(auto it = m_retired.begin(); it != m_retired.end();){
+						if(it->first <= oldest){
+							released.emplace_back(std::move(it->second));
+							it = m_retired.erase(it);
+						}
+						else{
+							++it;
+						}
+					}
+
+					m_num_retired.store(m_retired.size(), std::memory_order_release);
+				}
+			}
+
+		private:
+			void retire(library_map::node_type node){
+				const auto epoch = epochs().advance();
+
+				{
+					std::lock_guard lock(m_retired_mut);
+					m_retired.emplace_back(epoch, std::move(node));
+					m_num_retired.store(m_retired.size(), std::memory_order_release);
+				}
+
+				collect();
+			}
+
+			// open and register a library, m_mut must be held
+			const dynamic_library *publish(const fs::path &abs_path, std::optional<std::vector<std::string>> symbols = std::nullopt){
 				auto abs_path_utf8 = abs_path.u8string();
 
 				auto res = m_libraries.find(abs_path_utf8);
@@ -234,7 +1026,7 @@ namespace {
 					return &res->second;
 				}
 
-				auto emplace_res = m_libraries.try_emplace(abs_path_utf8, abs_path);
+				auto emplace_res = m_libraries.try_emplace(abs_path_utf8, abs_path, std::move(symbols));
 				if(!emplace_res.second){
 					print_error("Internal error in std::unordered_map::try_emplace");
 					return nullptr;
@@ -243,24 +1035,168 @@ namespace {
 				return &emplace_res.first->second;
 			}
 
-			const dynamic_library *self() const noexcept{
-				return &m_self;
-			}
+			std::mutex m_mut;
+			std::once_flag m_self_flag;
+			std::optional<dynamic_library> m_self;
+			library_map m_libraries;
+			std::size_t m_generation = 0;
 
-		private:
-			dynamic_library m_self;
-			std::unordered_map<std::string, dynamic_library> m_libraries;
+			std::mutex m_retired_mut;
+			std::atomic_size_t m_num_retired = 0;
+			std::vector<std::pair<std::uint64_t, library_map::node_type>> m_retired;
 	};
 
-	static plugin_loader loader;
+	plugin_loader &loader(){
+		static plugin_loader ret;
+		return ret;
+	}
+
+	std::vector<manifest_type> read_manifest(const unsigned char *data, std::size_t size){
+		using refl::detail::manifest_record;
+
+		std::vector<manifest_type> ret;
+
+		for(std::size_t off = 0; off + sizeof(manifest_record) <= size;){
+			manifest_record rec;
+			std::memcpy(&rec, data + off, sizeof(rec));
+
+			// records from different objects may be padded apart
+			if(rec.magic != refl::detail::manifest_magic){
+				off += alignof(refl::detail::manifest_entry<1>);
+				continue;
+			}
+
+			const std::size_t strings_size = std::size_t(rec.name_size) + 1 + rec.attributes_size;
+
+			if(
+				rec.record_size < sizeof(rec) || rec.record_size % alignof(refl::detail::manifest_entry<1>) != 0 ||
+				rec.record_size > size - off || strings_size > rec.record_size - sizeof(rec)
+			){
+				print_error("Corrupt manifest record at offset {}", off);
+				break;
+			}
+
+			auto strings = reinterpret_cast<const char*>(data + off + sizeof(rec));
+
+			ret.emplace_back(manifest_type{
+				std::string_view(strings, rec.name_size),
+				rec.id, rec.layout_fingerprint,
+				rec.size, rec.alignment,
+				rec.kind == refl::detail::manifest_kind::enum_,
+				rec.num_attributes,
+				std::string_view(strings + rec.name_size + 1, rec.attributes_size)
+			});
+
+			off += rec.record_size;
+		}
+
+		return ret;
+	}
 }
 
 const library *plugin::load(const fs::path &path){
-	return loader.load(path);
+	return loader().load(path);
+}
+
+std::vector<const library*> plugin::load_all(const std::vector<fs::path> &paths, std::size_t num_threads){
+	return loader().load_all(paths, num_threads);
+}
+
+const library *plugin::reload(const fs::path &path){
+	return loader().reload(path);
+}
+
+bool plugin::unload(const library *lib){
+	return loader().unload(lib);
+}
+
+plugin::reader_guard::reader_guard(){
+	epochs().enter(this_reader());
+}
+
+plugin::reader_guard::~reader_guard(){
+	if(epochs().leave(this_reader())){
+		loader().collect();
+	}
+}
+
+void plugin::set_layout_check(layout_check check) noexcept{
+	layout_check_policy.store(check, std::memory_order_relaxed);
 }
 
 const library *plugin::self(){
-	return loader.self();
+	return loader().self();
+}
+
+std::optional<std::vector<std::string_view>> plugin::manifest_type::attribute(std::string_view name) const{
+	auto it = attributes.data();
+	const auto end = it + attributes.size();
+
+	const auto next = [&]{
+		if(it >= end) return std::string_view();
+		std::string_view ret(it, strnlen(it, end - it));
+		it += ret.size() + 1;
+		return ret;
+	};
+
+	while(it < end){
+		auto attrib_name = next();
+		if(it >= end) break;
+
+		// arguments are counted, an empty one is a valid argument
+		const std::size_t num_args = static_cast<unsigned char>(*it++);
+
+		std::vector<std::string_view> args;
+		args.reserve(num_args);
+
+		for(std::size_t i = 0; i < num_args && it < end; i++){
+			args.emplace_back(next());
+		}
+
+		if(attrib_name == name){
+			return args;
+		}
+	}
+
+	return std::nullopt;
+}
+
+const plugin::manifest_type *plugin::manifest::find(std::string_view name) const noexcept{
+	auto res = std::find_if(m_types.begin(), m_types.end(), [name](auto &&type){ return type.name == name; });
+	return res != m_types.end() ? &*res : nullptr;
+}
+
+const plugin::manifest_type *plugin::manifest::find(std::uint64_t id) const noexcept{
+	auto res = std::find_if(m_types.begin(), m_types.end(), [id](auto &&type){ return type.id == id; });
+	return res != m_types.end() ? &*res : nullptr;
+}
+
+std::optional<plugin::manifest> plugin::inspect(const fs::path &path){
+	std::size_t size = 0;
+
+	auto sidecar_path = path;
+	sidecar_path += manifest_extension;
+
+	// a sidecar older than the plugin was made for a previous build of it
+	std::error_code sidecar_ec, plugin_ec;
+	const auto sidecar_time = fs::last_write_time(sidecar_path, sidecar_ec);
+	const auto plugin_time = fs::last_write_time(path, plugin_ec);
+
+	if(!sidecar_ec && !plugin_ec && sidecar_time >= plugin_time && fs::is_regular_file(sidecar_path)){
+		if(auto data = detail::map_file(sidecar_path, size)){
+			auto types = read_manifest(data.get(), size);
+			return manifest(std::move(data), std::move(types));
+		}
+	}
+
+	auto data = detail::map_file(path, size);
+	if(!data) return std::nullopt;
+
+	auto section = detail::find_manifest_section(data.get(), size);
+	if(!section) return std::nullopt;
+
+	auto types = read_manifest(data.get() + section->first, section->second);
+	return manifest(std::move(data), std::move(types));
 }
 
 std::vector<std::filesystem::path> plugin::nearby_plugins(){
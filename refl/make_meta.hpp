@@ -230,7 +230,11 @@ std::string make_member_meta(
 	}
 
 	if(m.is_accessable){
-		ptr_str = fmt::format("\t"	"static constexpr ptr_type ptr = &{}::{};\n", full_name, m.name);
+		ptr_str = fmt::format(
+			"\t"	"static constexpr ptr_type ptr = &{0}::{1};\n"
+			"\t"	"static constexpr std::size_t offset = metapp::detail::member_offset<{0}>([](auto cls){{ return offsetof(std::remove_pointer_t<decltype(cls)>, {1}); }});\n",
+			full_name, m.name
+		);
 	}
 	else{
 		ptr_str = fmt::format("\t"	"static constexpr metapp::inaccessible<ptr_type> ptr = {{}};\n");
@@ -7,7 +7,18 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <optional>
+#include <unordered_set>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define REFLCPP_X86_GATHER 1
+#endif
 
 #include "fmt/format.h"
 
@@ -33,26 +44,124 @@ namespace {
 	static refl::detail::int_info_helper_impl<std::uint32_t> uint32_refl;
 	static refl::detail::int_info_helper_impl<std::uint64_t> uint64_refl;
 
+	static refl::detail::int_info_helper_impl<bool> bool_refl;
+
 	static refl::detail::float_info_helper_impl<float> float_refl;
 	static refl::detail::float_info_helper_impl<double> double_refl;
 
+	template<typename T>
+	void strided_copy_n(const unsigned char *src, std::size_t stride, std::size_t n, unsigned char *dst) noexcept{
+		for(std::size_t i = 0; i < n; i++){
+			T val;
+			std::memcpy(&val, src + (i * stride), sizeof(T));
+			std::memcpy(dst + (i * sizeof(T)), &val, sizeof(T));
+		}
+	}
+
+#ifdef REFLCPP_X86_GATHER
+	__attribute__((target("avx2")))
+	std::size_t strided_copy_32_avx2(const unsigned char *src, std::size_t stride, std::size_t n, unsigned char *dst) noexcept{
+		const int s = static_cast<int>(stride);
+		const __m256i idx = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+
+		std::size_t i = 0;
+		for(; i + 8 <= n; i += 8){
+			const auto vals = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src + (i * stride)), idx, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i * 4)), vals);
+		}
+
+		return i;
+	}
+
+	__attribute__((target("avx2")))
+	std::size_t strided_copy_64_avx2(const unsigned char *src, std::size_t stride, std::size_t n, unsigned char *dst) noexcept{
+		const int s = static_cast<int>(stride);
+		const __m128i idx = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+
+		std::size_t i = 0;
+		for(; i + 4 <= n; i += 4){
+			const auto vals = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(src + (i * stride)), idx, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i * 8)), vals);
+		}
+
+		return i;
+	}
+
+	bool has_avx2() noexcept{
+		static const bool ret = __builtin_cpu_supports("avx2");
+		return ret;
+	}
+#endif
+
+	std::size_t pool_class(std::size_t n) noexcept{
+		std::size_t cls = 0;
+		while((refl::object_pool::min_block_size << cls) < n) ++cls;
+		return cls;
+	}
+
+	std::array<refl::type_info, 12> builtin_types() noexcept{
+		return {
+			&int8_refl, &int16_refl, &int32_refl, &int64_refl,
+			&uint8_refl, &uint16_refl, &uint32_refl, &uint64_refl,
+			&bool_refl,
+			&float_refl, &double_refl,
+			refl::detail::void_info()
+		};
+	}
+
+	// guards both loaders, recursive so a plugin swap can hold it across several registry calls
+	std::recursive_mutex registry_mutex;
+
+	struct address_range{
+		const void *begin, *end;
+
+		bool contains(const void *p) const noexcept{
+			return std::less_equal<const void*>()(begin, p) && std::less<const void*>()(p, end);
+		}
+	};
+
+	template<typename Map, typename Pred>
+	void erase_where(Map &map, Pred &&pred){
+		for(auto it = map.begin(); it != map.end();){
+			if(pred(it->second)){
+				it = map.erase(it);
+			}
+			else{
+				++it;
+			}
+		}
+	}
+
 	class type_loader{
 		public:
-			type_loader(){}
+			using entry_ptr = const refl::detail::type_export_entry*;
+
+			// either the registered type, or the entry exporting it if it hasn't been materialized yet
+			struct lookup{
+				refl::type_info info = nullptr;
+				entry_ptr entry = nullptr;
+			};
+
+			type_loader(){
+				for(auto type : builtin_types()){
+					index_type(type);
+				}
+			}
 
 			~type_loader(){}
 
-			refl::type_info load(std::string_view name){
+			lookup load(std::string_view name) const{
 				if(!m_types.empty()){
 					auto registered_res = m_types.find(name);
 					if(registered_res != m_types.end()){
-						return registered_res->second;
+						return { registered_res->second };
 					}
 				}
 
 				//fmt::print(stderr, "Failed to import reflected type '{}'\n", name);
 
-				return nullptr;
+				// ids are hashed from the name, so the tables can be searched without indexing every entry
+				return { nullptr, find_pending(metapp::detail::hash_name(name), [name](auto &&entry){ return entry.name == name; }) };
 			}
 
 			bool register_type(refl::type_info info, bool overwrite){
@@ -68,27 +177,149 @@ namespace {
 					}
 				}
 				else{
-					m_types[info->name()] = info;
+					// replace the key too, it may point into a library that is about to be unloaded
+					auto res = m_types.find(info->name());
+					if(res != m_types.end()){
+						// kept so it can be restored when the library overriding it is unloaded
+						if(res->second != info) m_shadowed.emplace_back(res->second);
+						m_types.erase(res);
+					}
+
+					m_types.emplace(info->name(), info);
 				}
 
+				m_shadowed.erase(std::remove(m_shadowed.begin(), m_shadowed.end(), info), m_shadowed.end());
+
+				index_type(info);
+
 				return true;
 			}
 
-			std::vector<refl::type_info> all(){
+			lookup load(std::type_index index) const{
+				auto res = m_by_index.find(index);
+				if(res != m_by_index.end()){
+					return { res->second };
+				}
+
+				// tables aren't ordered by type index, so their entries are indexed when registered
+				auto pending_res = m_pending_by_index.find(index);
+				if(pending_res != m_pending_by_index.end()){
+					return { nullptr, pending_res->second };
+				}
+
+				return {};
+			}
+
+			lookup load(std::type_index index, std::uint64_t id) const{
+				auto res = m_by_index.find(index);
+				if(res != m_by_index.end()){
+					return { res->second };
+				}
+
+				return { nullptr, find_pending(id, [index](auto &&entry){ return *entry.type == index; }) };
+			}
+
+			lookup load_by_id(std::uint64_t id) const{
+				auto res = m_by_id.find(id);
+				if(res != m_by_id.end()){
+					return { res->second };
+				}
+
+				return { nullptr, find_pending(id, [](auto&&){ return true; }) };
+			}
+
+			std::vector<entry_ptr> unmaterialized() const{
+				std::vector<entry_ptr> ret;
+
+				for(auto &&table : m_pending){
+					for(std::size_t i = 0; i < table.second; i++){
+						const auto entry = table.first + i;
+						if(m_by_index.find(*entry->type) == m_by_index.end()){
+							ret.emplace_back(entry);
+						}
+					}
+				}
+
+				return ret;
+			}
+
+			void register_table(const refl::detail::type_export_entry *entries, std::size_t n){
+				m_pending.emplace_back(entries, n);
+				index_table(entries, n);
+			}
+
+			void tables_in_range(address_range range, std::vector<refl::detail::export_tables> &out) const{
+				for(auto &&table : m_pending){
+					if(range.contains(table.first)){
+						out.emplace_back(refl::detail::export_tables{ table.first, table.second, nullptr, 0 });
+					}
+				}
+			}
+
+			void deregister_range(address_range range){
+				const auto in_range = [range](auto ptr){ return range.contains(ptr); };
+
+				erase_where(m_types, in_range);
+				erase_where(m_by_index, in_range);
+				erase_where(m_by_id, in_range);
+
+				m_shadowed.erase(std::remove_if(m_shadowed.begin(), m_shadowed.end(), in_range), m_shadowed.end());
+
+				// the latest registration each removed type overrode takes its place again
+				for(auto i = m_shadowed.size(); i-- > 0;){
+					auto info = m_shadowed[i];
+					if(m_types.find(info->name()) != m_types.end()) continue;
+
+					m_types.emplace(info->name(), info);
+					index_type(info);
+
+					m_shadowed.erase(m_shadowed.begin() + i);
+				}
+
+				const auto removed = std::remove_if(m_pending.begin(), m_pending.end(), [range](auto &&table){ return range.contains(table.first); });
+				if(removed == m_pending.end()) return;
+
+				m_pending.erase(removed, m_pending.end());
+
+				// entries of the remaining tables may have been shadowed by the removed ones
+				m_pending_by_index.clear();
+				for(auto &&table : m_pending){
+					index_table(table.first, table.second);
+				}
+			}
+
+			// without materializing anything, so a library can be checked before its types are used
+			std::uint64_t layout_fingerprint(std::uint64_t id, const std::vector<address_range> &excluded) const{
+				const auto included = [&excluded](const void *ptr){
+					return std::none_of(excluded.begin(), excluded.end(), [ptr](auto &&range){ return range.contains(ptr); });
+				};
+
+				const auto fingerprint = [](refl::type_info info) -> std::uint64_t{
+					auto cls = dynamic_cast<refl::class_info>(info);
+					return cls ? cls->layout_fingerprint() : 0;
+				};
+
+				auto res = m_by_id.find(id);
+				if(res != m_by_id.end() && included(res->second)){
+					return fingerprint(res->second);
+				}
+
+				// the latest registration an excluded type overrode
+				for(auto it = m_shadowed.rbegin(); it != m_shadowed.rend(); ++it){
+					if((*it)->id() == id && included(*it)) return fingerprint(*it);
+				}
+
+				auto entry = find_pending(id, [&included](auto &&entry){ return included(&entry); });
+				return entry ? entry->layout_fingerprint : 0;
+			}
+
+			std::vector<refl::type_info> all() const{
 				std::vector<refl::type_info> ret;
 				ret.reserve(m_types.size() + 32);
 
-				ret.emplace_back(&int8_refl);
-				ret.emplace_back(&int16_refl);
-				ret.emplace_back(&int32_refl);
-				ret.emplace_back(&int64_refl);
-				ret.emplace_back(&uint8_refl);
-				ret.emplace_back(&uint16_refl);
-				ret.emplace_back(&uint32_refl);
-				ret.emplace_back(&uint64_refl);
-				ret.emplace_back(&float_refl);
-				ret.emplace_back(&double_refl);
-				ret.emplace_back(refl::detail::void_info());
+				for(auto type : builtin_types()){
+					ret.emplace_back(type);
+				}
 
 				for(auto &&type_p : m_types){
 					ret.emplace_back(type_p.second);
@@ -97,7 +328,7 @@ namespace {
 				return ret;
 			}
 
-			std::vector<refl::class_info> all_classes(){
+			std::vector<refl::class_info> all_classes() const{
 				std::vector<refl::class_info> ret;
 				ret.reserve(m_types.size());
 
@@ -110,10 +341,176 @@ namespace {
 			}
 
 		private:
+			void index_type(refl::type_info info){
+				// the key refers to a std::type_info that may belong to a library about to be unloaded
+				m_by_index.erase(info->type_index());
+				m_by_index.emplace(info->type_index(), info);
+				m_by_id[info->id()] = info;
+			}
+
+			// earlier tables take precedence, so existing entries are kept
+			void index_table(entry_ptr entries, std::size_t n){
+				for(std::size_t i = 0; i < n; i++){
+					m_pending_by_index.try_emplace(*entries[i].type, entries + i);
+				}
+			}
+
+			// tables are sorted by id, earlier tables take precedence like registered types do
+			template<typename Pred>
+			entry_ptr find_pending(std::uint64_t id, Pred &&pred) const{
+				for(auto &&table : m_pending){
+					const auto end = table.first + table.second;
+
+					auto it = std::lower_bound(table.first, end, id, [](auto &&entry, std::uint64_t id){ return entry.id < id; });
+
+					for(; it != end && it->id == id; ++it){
+						if(pred(*it)) return it;
+					}
+				}
+
+				return nullptr;
+			}
+
 			std::unordered_map<std::string_view, refl::type_info> m_types;
+			std::unordered_map<std::type_index, refl::type_info> m_by_index;
+			std::unordered_map<std::uint64_t, refl::type_info> m_by_id;
+			std::vector<refl::type_info> m_shadowed;
+
+			std::vector<std::pair<entry_ptr, std::size_t>> m_pending;
+			std::unordered_map<std::type_index, entry_ptr> m_pending_by_index;
 	};
 
 	type_loader REFLCPP_EXPORT_SYMBOL loader;
+
+	using refl::detail::strip_global_scope;
+
+	class function_loader{
+		public:
+			using entry_ptr = const refl::detail::function_export_entry*;
+
+			refl::function_info load(refl::detail::function_address address) const{
+				auto res = m_by_address.find(address);
+				return res != m_by_address.end() ? res->second : nullptr;
+			}
+
+			std::vector<refl::function_info> load(std::string_view name) const{
+				auto res = m_by_name.find(strip_global_scope(name));
+				return res != m_by_name.end() ? res->second : std::vector<refl::function_info>{};
+			}
+
+			// tables are sorted by unqualified name, so every overload is found with one search per table
+			std::vector<entry_ptr> unmaterialized(std::string_view name) const{
+				name = strip_global_scope(name);
+
+				std::vector<entry_ptr> ret;
+
+				for(auto &&table : m_pending){
+					const auto end = table.first + table.second;
+
+					auto it = std::lower_bound(table.first, end, name, [](auto &&entry, std::string_view name){ return strip_global_scope(entry.name) < name; });
+
+					for(; it != end && strip_global_scope(it->name) == name; ++it){
+						if(m_materialized.find(it) == m_materialized.end()){
+							ret.emplace_back(it);
+						}
+					}
+				}
+
+				return ret;
+			}
+
+			std::vector<entry_ptr> unmaterialized() const{
+				std::vector<entry_ptr> ret;
+
+				for(auto &&table : m_pending){
+					for(std::size_t i = 0; i < table.second; i++){
+						if(m_materialized.find(table.first + i) == m_materialized.end()){
+							ret.emplace_back(table.first + i);
+						}
+					}
+				}
+
+				return ret;
+			}
+
+			void materialized(entry_ptr entry, refl::function_info info){
+				if(m_materialized.emplace(entry).second && info){
+					register_function(info);
+				}
+			}
+
+			bool register_function(refl::function_info info){
+				if(!m_by_address.try_emplace(info->address(), info).second){
+					return false;
+				}
+
+				m_by_name[strip_global_scope(info->name())].emplace_back(info);
+				return true;
+			}
+
+			void register_table(const refl::detail::function_export_entry *entries, std::size_t n){
+				m_pending.emplace_back(entries, n);
+			}
+
+			void tables_in_range(address_range range, std::vector<refl::detail::export_tables> &out) const{
+				for(auto &&table : m_pending){
+					if(range.contains(table.first)){
+						out.emplace_back(refl::detail::export_tables{ nullptr, 0, table.first, table.second });
+					}
+				}
+			}
+
+			void deregister_range(address_range range){
+				const auto in_range = [range](auto ptr){ return range.contains(ptr); };
+
+				erase_where(m_by_address, in_range);
+
+				for(auto it = m_by_name.begin(); it != m_by_name.end();){
+					auto &&overloads = it->second;
+					overloads.erase(std::remove_if(overloads.begin(), overloads.end(), in_range), overloads.end());
+
+					if(overloads.empty()){
+						it = m_by_name.erase(it);
+						continue;
+					}
+					else if(range.contains(it->first.data())){
+						// the name was owned by a removed overload, so take it from one that remains
+						auto node = m_by_name.extract(it++);
+						node.key() = strip_global_scope(node.mapped().front()->name());
+						m_by_name.insert(std::move(node));
+						continue;
+					}
+
+					++it;
+				}
+
+				m_pending.erase(
+					std::remove_if(m_pending.begin(), m_pending.end(), [range](auto &&table){ return range.contains(table.first); }),
+					m_pending.end()
+				);
+
+				for(auto it = m_materialized.begin(); it != m_materialized.end();){
+					if(range.contains(*it)){
+						it = m_materialized.erase(it);
+					}
+					else{
+						++it;
+					}
+				}
+			}
+
+		private:
+			std::unordered_map<refl::detail::function_address, refl::function_info> m_by_address;
+			std::unordered_map<std::string_view, std::vector<refl::function_info>> m_by_name;
+
+			std::vector<std::pair<entry_ptr, std::size_t>> m_pending;
+			std::unordered_set<entry_ptr> m_materialized;
+	};
+
+	function_loader fn_loader;
+
+	// registrations made by this thread are held back while it is set
+	thread_local refl::detail::registration_stage *current_stage = nullptr;
 }
 
 refl::type_info refl::detail::void_info() noexcept{
@@ -124,24 +521,28 @@ refl::type_info refl::detail::void_info() noexcept{
 refl::int_info refl::detail::int_info(std::size_t bits, bool is_signed) noexcept{
 	if(is_signed){
 		switch(bits){
-			case 8: return &uint8_refl;
-			case 16: return &uint16_refl;
-			case 32: return &uint32_refl;
-			case 64: return &uint64_refl;
+			case 8: return &int8_refl;
+			case 16: return &int16_refl;
+			case 32: return &int32_refl;
+			case 64: return &int64_refl;
 			default: return nullptr;
 		}
 	}
 	else{
 		switch(bits){
-			case 8: return &int8_refl;
-			case 16: return &int16_refl;
-			case 32: return &int32_refl;
-			case 64: return &int64_refl;
+			case 8: return &uint8_refl;
+			case 16: return &uint16_refl;
+			case 32: return &uint32_refl;
+			case 64: return &uint64_refl;
 			default: return nullptr;
 		}
 	}
 }
 
+refl::int_info refl::detail::bool_info() noexcept{
+	return &bool_refl;
+}
+
 refl::num_info refl::detail::float_info(std::size_t bits) noexcept{
 	switch(bits){
 		case 32: return &float_refl;
@@ -150,19 +551,397 @@ refl::num_info refl::detail::float_info(std::size_t bits) noexcept{
 	}
 }
 
+void refl::detail::strided_copy(const void *src_void, std::size_t stride, std::size_t n, void *dst_void, std::size_t elem_size) noexcept{
+	auto src = reinterpret_cast<const unsigned char*>(src_void);
+	auto dst = reinterpret_cast<unsigned char*>(dst_void);
+
+	if(stride == elem_size){
+		std::memcpy(dst, src, n * elem_size);
+		return;
+	}
+
+#ifdef REFLCPP_X86_GATHER
+	// gather indices are 32-bit byte offsets
+	if(has_avx2() && stride <= (INT32_MAX / 8)){
+		std::size_t done = 0;
+
+		if(elem_size == 4){
+			done = strided_copy_32_avx2(src, stride, n, dst);
+		}
+		else if(elem_size == 8){
+			done = strided_copy_64_avx2(src, stride, n, dst);
+		}
+
+		src += done * stride;
+		dst += done * elem_size;
+		n -= done;
+	}
+#endif
+
+	switch(elem_size){
+		case 1: strided_copy_n<std::uint8_t>(src, stride, n, dst); break;
+		case 2: strided_copy_n<std::uint16_t>(src, stride, n, dst); break;
+		case 4: strided_copy_n<std::uint32_t>(src, stride, n, dst); break;
+		case 8: strided_copy_n<std::uint64_t>(src, stride, n, dst); break;
+
+		default:{
+			for(std::size_t i = 0; i < n; i++){
+				std::memcpy(dst + (i * elem_size), src + (i * stride), elem_size);
+			}
+
+			break;
+		}
+	}
+}
+
+refl::object_pool::object_pool(std::size_t max_cached) noexcept
+	: m_max_cached(max_cached){}
+
+refl::object_pool::~object_pool(){
+	release();
+}
+
+namespace {
+	// trivially destructible, so it can still be read after the pool itself is destroyed on thread exit
+	thread_local bool local_pool_destroyed = false;
+
+	struct local_object_pool: refl::object_pool{
+		~local_object_pool(){ local_pool_destroyed = true; }
+	};
+}
+
+refl::object_pool &refl::object_pool::local() noexcept{
+	thread_local local_object_pool pool;
+	return pool;
+}
+
+refl::object_pool *refl::object_pool::try_local() noexcept{
+	return local_pool_destroyed ? nullptr : &local();
+}
+
+void *refl::object_pool::allocate_block(refl::type_info type){
+	const std::size_t size_cls = pool_class(type->size());
+	const std::size_t align_cls = pool_class(type->alignment());
+
+	if(size_cls >= num_size_classes || align_cls >= num_align_classes){
+		return detail::allocate_aligned(std::allocator<unsigned char>(), type->size(), type->alignment());
+	}
+
+	return detail::allocate_aligned(std::allocator<unsigned char>(), min_block_size << size_cls, min_block_size << align_cls);
+}
+
+void refl::object_pool::deallocate_block(void *p, refl::type_info type) noexcept{
+	const std::size_t size_cls = pool_class(type->size());
+	const std::size_t align_cls = pool_class(type->alignment());
+
+	if(size_cls >= num_size_classes || align_cls >= num_align_classes){
+		detail::deallocate_aligned(std::allocator<unsigned char>(), p, type->size(), type->alignment());
+		return;
+	}
+
+	detail::deallocate_aligned(std::allocator<unsigned char>(), p, min_block_size << size_cls, min_block_size << align_cls);
+}
+
+void *refl::object_pool::allocate(refl::type_info type){
+	const std::size_t size_cls = pool_class(type->size());
+	const std::size_t align_cls = pool_class(type->alignment());
+
+	if(size_cls < num_size_classes && align_cls < num_align_classes){
+		auto &&list = m_lists[size_cls][align_cls];
+		if(list.head){
+			void *ret = list.head;
+			list.head = *reinterpret_cast<void**>(ret);
+			--list.count;
+			++m_hits;
+			return ret;
+		}
+	}
+
+	++m_misses;
+	return allocate_block(type);
+}
+
+void refl::object_pool::deallocate(void *p, refl::type_info type) noexcept{
+	const std::size_t size_cls = pool_class(type->size());
+	const std::size_t align_cls = pool_class(type->alignment());
+
+	if(size_cls < num_size_classes && align_cls < num_align_classes){
+		auto &&list = m_lists[size_cls][align_cls];
+		if(list.count < m_max_cached){
+			*reinterpret_cast<void**>(p) = list.head;
+			list.head = p;
+			++list.count;
+			return;
+		}
+	}
+
+	deallocate_block(p, type);
+}
+
+void refl::object_pool::release() noexcept{
+	for(std::size_t size_cls = 0; size_cls < num_size_classes; size_cls++){
+		for(std::size_t align_cls = 0; align_cls < num_align_classes; align_cls++){
+			auto &&list = m_lists[size_cls][align_cls];
+
+			while(list.head){
+				void *block = list.head;
+				list.head = *reinterpret_cast<void**>(block);
+				detail::deallocate_aligned(std::allocator<unsigned char>(), block, min_block_size << size_cls, min_block_size << align_cls);
+			}
+
+			list.count = 0;
+		}
+	}
+}
+
+refl::detail::registry_lock::registry_lock(){
+	registry_mutex.lock();
+}
+
+refl::detail::registry_lock::~registry_lock(){
+	registry_mutex.unlock();
+}
+
+// bumped whenever entities are removed, so cached lookups know to look again
+std::atomic<std::uint64_t> refl::detail::registry_generation_count = 1;
+
+void refl::detail::deregister_range(const void *begin, const void *end){
+	registry_lock lock;
+	loader.deregister_range({ begin, end });
+	fn_loader.deregister_range({ begin, end });
+	registry_generation_count.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t refl::detail::registered_layout_fingerprint(std::uint64_t id, const std::vector<std::pair<const void*, const void*>> &excluded){
+	std::vector<address_range> ranges;
+	ranges.reserve(excluded.size());
+
+	for(auto &&range : excluded){
+		ranges.emplace_back(address_range{ range.first, range.second });
+	}
+
+	registry_lock lock;
+	return loader.layout_fingerprint(id, ranges);
+}
+
+namespace {
+	// an export function can wait on a static init guard held by a thread that is itself waiting on the registry,
+	// so they are only ever called with the registry unlocked
+	refl::type_info materialize(type_loader::lookup res){
+		if(res.info || !res.entry) return res.info;
+
+		auto info = res.entry->fn();
+		if(info){
+			refl::detail::registry_lock lock;
+			loader.register_type(info, false);
+		}
+
+		return info;
+	}
+
+	template<typename Find>
+	refl::type_info load_type(Find &&find){
+		type_loader::lookup res;
+
+		{
+			refl::detail::registry_lock lock;
+			res = find();
+		}
+
+		return materialize(res);
+	}
+
+	void materialize_types(){
+		std::vector<type_loader::entry_ptr> entries;
+
+		{
+			refl::detail::registry_lock lock;
+			entries = loader.unmaterialized();
+		}
+
+		for(auto entry : entries){
+			materialize({ nullptr, entry });
+		}
+	}
+
+	void materialize_functions(const std::vector<function_loader::entry_ptr> &entries){
+		for(auto entry : entries){
+			auto info = entry->fn();
+
+			refl::detail::registry_lock lock;
+			fn_loader.materialized(entry, info);
+		}
+	}
+}
+
+refl::detail::registration_stage::registration_stage()
+	: m_prev(std::exchange(current_stage, this))
+{}
+
+refl::detail::registration_stage::~registration_stage(){
+	stop();
+}
+
+void refl::detail::registration_stage::stop() noexcept{
+	if(m_active){
+		current_stage = m_prev;
+		m_active = false;
+	}
+}
+
+void refl::detail::registration_stage::publish(){
+	stop();
+
+	registry_lock lock;
+
+	for(auto &&table : m_type_tables){
+		register_type_table(table.first, table.second);
+	}
+
+	for(auto &&table : m_function_tables){
+		register_function_table(table.first, table.second);
+	}
+
+	for(auto &&type : m_types){
+		register_type(type.first, type.second);
+	}
+
+	for(auto fn : m_fns){
+		register_function(fn);
+	}
+
+	m_type_tables.clear();
+	m_function_tables.clear();
+	m_types.clear();
+	m_fns.clear();
+}
+
+std::vector<refl::detail::export_tables> refl::detail::registered_tables(const void *begin, const void *end){
+	const address_range range{ begin, end };
+	std::vector<export_tables> ret;
+
+	// a staged library looks up the tables it registered itself
+	for(auto stage = current_stage; stage; stage = stage->m_prev){
+		for(auto &&table : stage->m_type_tables){
+			if(range.contains(table.first)){
+				ret.emplace_back(export_tables{ table.first, table.second, nullptr, 0 });
+			}
+		}
+
+		for(auto &&table : stage->m_function_tables){
+			if(range.contains(table.first)){
+				ret.emplace_back(export_tables{ nullptr, 0, table.first, table.second });
+			}
+		}
+	}
+
+	registry_lock lock;
+	loader.tables_in_range(range, ret);
+	fn_loader.tables_in_range(range, ret);
+	return ret;
+}
+
+void refl::detail::register_function_table(const refl::detail::function_export_entry *entries, std::size_t n){
+	if(current_stage){
+		current_stage->m_function_tables.emplace_back(entries, n);
+		return;
+	}
+
+	registry_lock lock;
+	fn_loader.register_table(entries, n);
+}
+
+bool refl::detail::register_function(refl::function_info info){
+	if(current_stage){
+		current_stage->m_fns.emplace_back(info);
+		return true;
+	}
+
+	registry_lock lock;
+	return fn_loader.register_function(info);
+}
+
+refl::function_info refl::reflect_function(refl::detail::function_address address){
+	std::vector<function_loader::entry_ptr> entries;
+
+	{
+		detail::registry_lock lock;
+
+		if(auto ret = fn_loader.load(address)){
+			return ret;
+		}
+
+		// addresses are only known once a function is materialized
+		entries = fn_loader.unmaterialized();
+	}
+
+	materialize_functions(entries);
+
+	detail::registry_lock lock;
+	return fn_loader.load(address);
+}
+
+std::vector<refl::function_info> refl::reflect_function(std::string_view name){
+	std::vector<function_loader::entry_ptr> entries;
+
+	{
+		detail::registry_lock lock;
+		entries = fn_loader.unmaterialized(name);
+	}
+
+	materialize_functions(entries);
+
+	detail::registry_lock lock;
+	return fn_loader.load(name);
+}
+
+void refl::detail::register_type_table(const refl::detail::type_export_entry *entries, std::size_t n){
+	if(current_stage){
+		current_stage->m_type_tables.emplace_back(entries, n);
+		return;
+	}
+
+	registry_lock lock;
+	loader.register_table(entries, n);
+}
+
 bool refl::detail::register_type(refl::type_info info, bool overwrite){
+	if(current_stage){
+		current_stage->m_types.emplace_back(info, overwrite);
+		return true;
+	}
+
+	registry_lock lock;
 	return loader.register_type(info, overwrite);
 }
 
 refl::type_info refl::reflect(std::string_view name){
-	return loader.load(name);
+	return load_type([name]{ return loader.load(name); });
+}
+
+refl::type_info refl::reflect(std::type_index index){
+	return load_type([index]{ return loader.load(index); });
+}
+
+refl::type_info refl::detail::reflect_exact(std::type_index index, std::uint64_t id){
+	return load_type([index, id]{ return loader.load(index, id); });
+}
+
+refl::type_info refl::reflect_by_id(std::uint64_t id){
+	return load_type([id]{ return loader.load_by_id(id); });
 }
 
 std::vector<refl::type_info> refl::reflect_all(){
+	materialize_types();
+
+	detail::registry_lock lock;
 	return loader.all();
 }
 
 std::vector<refl::class_info> refl::reflect_all_classes(){
+	materialize_types();
+
+	detail::registry_lock lock;
 	return loader.all_classes();
 }
 
@@ -7,6 +7,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
 #include <fstream>
@@ -19,7 +20,52 @@
 
 namespace fs = std::filesystem;
 
-std::string make_function_refl(const ast::function_info &fn){
+struct refl_tables{
+	std::string types, functions;
+	std::size_t num_types = 0, num_functions = 0;
+};
+
+std::string export_tables_symbol(const fs::path &output_dir, const fs::path &header){
+	// 64-bit FNV-1a of the output and header paths, unique per generated source
+	const auto key = fs::absolute(output_dir).string() + '|' + fs::absolute(header).string();
+
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+
+	for(char c : key){
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3ull;
+	}
+
+	return fmt::format("reflpp_export_tables_{:016x}", hash);
+}
+
+std::string make_library_refl(const std::vector<std::string> &table_symbols){
+	std::string decls, ptrs;
+
+	for(auto &&sym : table_symbols){
+		decls += fmt::format("REFLCPP_HIDDEN_SYMBOL extern const reflpp::detail::export_tables {};\n", sym);
+		ptrs += fmt::format("\t"	"&{},\n", sym);
+	}
+
+	return fmt::format(
+		"#include \"metacpp/refl.hpp\"\n"
+		"\n"
+		"{0}"
+		"\n"
+		"static const reflpp::detail::export_tables *const reflpp_library_tables[] = {{\n"
+			"{1}"
+		"}};\n"
+		"\n"
+		"static const reflpp::detail::library_exports reflpp_library_exports_val = {{ reflpp_library_tables, {2} }};\n"
+		"\n"
+		"extern \"C\" REFLCPP_EXPORT_SYMBOL const reflpp::detail::library_exports *reflpp_library_exports(){{\n"
+		"\t"	"return &reflpp_library_exports_val;\n"
+		"}}\n",
+		decls, ptrs, table_symbols.size()
+	);
+}
+
+std::string make_function_refl(const ast::function_info &fn, refl_tables &tables){
 	std::string full_name = fn.name;
 	std::string param_names_arr, param_types_arr, param_types_str;
 
@@ -36,12 +82,11 @@ std::string make_function_refl(const ast::function_info &fn){
 			auto &&param_type = fn.param_types[i];
 
 			param_names_arr += fmt::format(", \"{}\"", param_name);
-			param_types_arr += fmt::format(", reflpp::reflect<{}>()", param_type);
+			param_types_arr += fmt::format("\t"	"\t"	"\t"	"\t"	"case {}: return reflpp::reflect<{}>();\n", i, param_type);
 			param_types_str += fmt::format(", {}", param_type);
 		}
 
 		param_names_arr.erase(0, 2);
-		param_types_arr.erase(0, 2);
 		param_types_str.erase(0, 2);
 
 		param_names_arr = fmt::format(
@@ -51,10 +96,14 @@ std::string make_function_refl(const ast::function_info &fn){
 			param_names_arr
 		);
 
+		// reflected on demand, caching them here would keep pointers into libraries that may be unloaded
 		param_types_arr = fmt::format(
-			"\t"	"\t"	"const reflpp::type_info param_type_arr[{}] = {{ {} }};\n"
-			"\t"	"\t"	"reflpp::type_info param_type(std::size_t idx) const noexcept override{{ return idx >= num_params() ? nullptr : param_type_arr[idx]; }}\n",
-			fn.param_types.size(),
+			"\t"	"\t"	"reflpp::type_info param_type(std::size_t idx) const noexcept override{{\n"
+			"\t"	"\t"	"\t"	"switch(idx){{\n"
+							"{}"
+			"\t"	"\t"	"\t"	"\t"	"default: return nullptr;\n"
+			"\t"	"\t"	"\t"	"}}\n"
+			"\t"	"\t"	"}}\n",
 			param_types_arr
 		);
 	}
@@ -68,15 +117,23 @@ std::string make_function_refl(const ast::function_info &fn){
 		fn.result_type, param_types_str, full_name
 	);
 
+	tables.functions += fmt::format(
+		"\t"	"reflpp::detail::function_export_entry{{ \"{}\", &reflpp::detail::function_export<({})> }},\n",
+		full_name, fn_val
+	);
+
+	++tables.num_functions;
+
 	return fmt::format(
-		"template<> REFLCPP_EXPORT_SYMBOL reflpp::function_info reflpp::detail::function_export<({5})>(){{\n"
+		"template<> REFLCPP_LOCAL_EXPORT_SYMBOL reflpp::function_info reflpp::detail::function_export<({5})>(){{\n"
 		"\t"	"struct function_info_impl: detail::function_info_helper{{\n"
 		"\t"	"\t"	"std::string_view name() const noexcept override{{ return \"{0}\"; }}\n"
-		"\t"	"\t"	"const reflpp::type_info result_type_val = reflpp::reflect<{1}>();\n"
-		"\t"	"\t"	"reflpp::type_info result_type() const noexcept override{{ return result_type_val; }}\n"
+		"\t"	"\t"	"reflpp::type_info result_type() const noexcept override{{ return reflpp::reflect<{1}>(); }}\n"
 		"\t"	"\t"	"std::size_t num_params() const noexcept override{{ return {2}; }}\n"
 						"{3}"
 						"{4}"
+		"\t"	"\t"	"reflpp::detail::function_address address() const noexcept override{{ return reinterpret_cast<reflpp::detail::function_address>({5}); }}\n"
+		"\t"	"\t"	"bool invoke(void *const *args, void *result) const override{{ reflpp::detail::invoke_function<({5})>({5}, args, result); return true; }}\n"
 		"\t"	"}} static ret;\n"
 		"\t"	"return &ret;\n"
 		"}}\n",
@@ -89,51 +146,59 @@ std::string make_function_refl(const ast::function_info &fn){
 	);
 }
 
-std::string make_namespace_refl(const ast::namespace_info &ns, std::string &ctor_calls){
+std::string make_namespace_refl(const ast::namespace_info &ns, refl_tables &tables){
 	std::string output;
 
 	for(auto &&fns : ns.functions){
 		for(auto &&fn : fns.second){
-			output += fmt::format("{}\n", make_function_refl(*fn));
+			output += fmt::format("{}\n", make_function_refl(*fn, tables));
 		}
 	}
 
 	for(auto &&enm : ns.enums){
 		output += fmt::format(
-			"template<> REFLCPP_EXPORT_SYMBOL reflpp::type_info reflpp::detail::type_export<{0}>(){{\n"
+			"template<> REFLCPP_LOCAL_EXPORT_SYMBOL reflpp::type_info reflpp::detail::type_export<{0}>(){{\n"
 			"\t"	"static const auto ret = reflpp::detail::reflect_info<{0}>::reflect();\n"
 			"\t"	"return ret;\n"
 			"}}\n"
+			"\n"
+			"REFLCPP_MANIFEST_SECTION static constexpr auto reflpp_manifest_{1} = reflpp::detail::make_manifest_entry<{0}>();\n"
 			"\n",
-			enm.second->name
+			enm.second->name, tables.num_types
 		);
 
-		ctor_calls += fmt::format(
-			"\t"	"reflpp::detail::type_export<{}>();\n",
+		tables.types += fmt::format(
+			"\t"	"reflpp::detail::make_type_export_entry<{}>(),\n",
 			enm.second->name
 		);
+
+		++tables.num_types;
 	}
 
 	for(auto &&cls : ns.classes){
 		if(cls.second->is_template) continue;
 
 		output += fmt::format(
-			"template<> REFLCPP_EXPORT_SYMBOL reflpp::type_info reflpp::detail::type_export<{0}>(){{\n"
+			"template<> REFLCPP_LOCAL_EXPORT_SYMBOL reflpp::type_info reflpp::detail::type_export<{0}>(){{\n"
 			"\t"	"static const auto ret = reflpp::detail::reflect_info<{0}>::reflect();\n"
 			"\t"	"return ret;\n"
 			"}}\n"
+			"\n"
+			"REFLCPP_MANIFEST_SECTION static constexpr auto reflpp_manifest_{1} = reflpp::detail::make_manifest_entry<{0}>();\n"
 			"\n",
-			cls.second->name
+			cls.second->name, tables.num_types
 		);
 
-		ctor_calls += fmt::format(
-			"\t"	"reflpp::detail::type_export<{}>();\n",
+		tables.types += fmt::format(
+			"\t"	"reflpp::detail::make_type_export_entry<{}>(),\n",
 			cls.second->name
 		);
+
+		++tables.num_types;
 	}
 
 	for(auto &&inner : ns.namespaces){
-		output += make_namespace_refl(*inner.second, ctor_calls);
+		output += make_namespace_refl(*inner.second, tables);
 	}
 
 	return output;
@@ -148,7 +213,7 @@ void print_version(){
 }
 
 void print_usage(const char *argv0, std::FILE *out = stdout){
-	fmt::print(out, "Usage: {} [-v|--version] [-d|--debug] [-o <out-dir>] <build-dir> header [other-headers ..]\n", argv0);
+	fmt::print(out, "Usage: {} [-v|--version] [-d|--debug] [-o <out-dir>] [-l <library-source>] <build-dir> header [other-headers ..]\n", argv0);
 }
 
 int main(int argc, char *argv[]){
@@ -170,6 +235,8 @@ int main(int argc, char *argv[]){
 	fs::path build_dir;
 	std::string build_dir_utf8;
 
+	fs::path library_source;
+
 	std::vector<fs::path> headers;
 
 	headers.reserve(argc - 2); // we know argc >= 3
@@ -207,6 +274,15 @@ int main(int argc, char *argv[]){
 				return EXIT_FAILURE;
 			}
 		}
+		else if(arg == "-l"){
+			++argi;
+			if(argi == argc){
+				print_usage(argv[0], stderr);
+				return EXIT_FAILURE;
+			}
+
+			library_source = fs::path(argv[argi]);
+		}
 		else if(arg == "-d" || arg == "--debug"){
 			verbose = true;
 
@@ -333,23 +409,43 @@ int main(int argc, char *argv[]){
 				out_source_path += ".refl.cpp";
 				auto out_source_path_utf8 = out_source_path.u8string();
 
-				std::string ctor_calls;
-				auto namespace_refl = make_namespace_refl(info.global, ctor_calls);
+				refl_tables tables;
+				auto namespace_refl = make_namespace_refl(info.global, tables);
 
 				std::string out_source = fmt::format(
 					"#define REFLCPP_IMPLEMENTATION\n"
-					"#include \"{}\"\n"
+					"#include \"{0}\"\n"
 					"#include \"metacpp/refl.hpp\"\n"
 					"\n"
-					"{}"
+					"{1}"
+					"\n"
+					"static constexpr auto reflpp_type_table = reflpp::detail::sort_type_table(std::array<reflpp::detail::type_export_entry, {2}>{{{{\n"
+							"{3}"
+					"}}}});\n"
+					"\n"
+					"static constexpr auto reflpp_function_table = reflpp::detail::sort_function_table(std::array<reflpp::detail::function_export_entry, {4}>{{{{\n"
+							"{5}"
+					"}}}});\n"
+					"\n"
+					"REFLCPP_HIDDEN_SYMBOL extern const reflpp::detail::export_tables {6};\n"
+					"\n"
+					"const reflpp::detail::export_tables {6} = {{\n"
+					"\t"	"reflpp_type_table.data(), reflpp_type_table.size(),\n"
+					"\t"	"reflpp_function_table.data(), reflpp_function_table.size()\n"
+					"}};\n"
 					"\n"
 					"__attribute__((constructor))\n"
 					"static void reflpp_load_type_info(){{\n"
-							"{}"
+					"\t"	"reflpp::detail::register_type_table(reflpp_type_table.data(), reflpp_type_table.size());\n"
+					"\t"	"reflpp::detail::register_function_table(reflpp_function_table.data(), reflpp_function_table.size());\n"
 					"}}",
 					fs::absolute(out_header_path).string(),
 					namespace_refl,
-					ctor_calls
+					tables.num_types,
+					tables.types,
+					tables.num_functions,
+					tables.functions,
+					export_tables_symbol(output_dir, header)
 				);
 
 				std::string out_header = fmt::format(
@@ -398,5 +494,22 @@ int main(int argc, char *argv[]){
 		fut.get();
 	}
 
+	if(!library_source.empty()){
+		std::vector<std::string> table_symbols;
+		table_symbols.reserve(headers.size());
+
+		for(const auto &header : headers){
+			table_symbols.emplace_back(export_tables_symbol(output_dir, header));
+		}
+
+		std::ofstream library_source_file(library_source);
+		if(!library_source_file){
+			fmt::print(stderr, "could not create output file '{}'\n", library_source.string());
+			return EXIT_FAILURE;
+		}
+
+		library_source_file << make_library_refl(table_symbols);
+	}
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,11 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// exported without any visibility annotation, plugins keep the default visibility of the code they're built from
+extern "C" int example_plugin_version(){ return 1; }
@@ -18,10 +18,10 @@
 
 class [[my::attrib(1, "2", 3.0)]] example{
 	public:
-		void method1(std::string_view s) const noexcept;
-		void method1(const std::string &str) noexcept;
+		void method1(std::string_view s) const noexcept{}
+		void method1(const std::string &str) noexcept{}
 
-		std::tuple<int, float, char> method2();
+		std::tuple<int, float, char> method2(){ return {}; }
 };
 
 class example_test_derived: public TestTemplateClass<std::string_view>{
@@ -0,0 +1,18 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "metacpp/meta.hpp"
+
+// reflected by loader-test, plugin-test-mismatch exports another layout under the same name
+class layout_example{
+	public:
+		int value = 0;
+};
@@ -0,0 +1,21 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "metacpp/meta.hpp"
+
+// reflected in an object library that is linked into plugin-test-other
+class static_example{
+	public:
+		int value() const noexcept{ return m_value; }
+
+	private:
+		int m_value = 0;
+};
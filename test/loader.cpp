@@ -7,23 +7,147 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 #include "fmt/format.h"
 
 #include "metacpp/plugin.hpp"
 
 #include "test/example.meta.h"
+#include "test/layout_example.h"
+#include "test/static_example.h"
 
 int main(int argc, char *argv[]){
+	{
+		// opened on first use, racing callers all get the same library
+		std::vector<const plugin::library*> selves(4, nullptr);
+		std::vector<std::thread> threads;
+
+		for(std::size_t i = 0; i < selves.size(); i++){
+			threads.emplace_back([&selves, i]{ selves[i] = plugin::self(); });
+		}
+
+		for(auto &&thread : threads){
+			thread.join();
+		}
+
+		const auto self = plugin::self();
+		assert(self && std::all_of(selves.begin(), selves.end(), [self](auto lib){ return lib == self; }));
+
+		// read once on first use, then shared
+		auto &&symbols = self->symbols();
+		assert(&symbols == &self->symbols());
+		assert(std::find(symbols.begin(), symbols.end(), refl::detail::library_exports_symbol) != symbols.end());
+
+		auto mangled = std::find_if(symbols.begin(), symbols.end(), [](auto &&sym){ return sym.rfind("_Z", 0) == 0; });
+		assert(mangled != symbols.end());
+
+		const auto demangled = self->demangle(*mangled);
+		assert(demangled != *mangled && self->demangle(*mangled) == demangled);
+	}
+
+	namespace fs = std::filesystem;
+	using namespace std::string_view_literals;
+
 	auto plugs = plugin::nearby_plugins();
 
-	for(auto &&path : plugs){
-		plugin::load(path);
+	const auto example_path_it = std::find_if(plugs.begin(), plugs.end(), [](auto &&path){
+		auto manifest = plugin::inspect(path);
+		return manifest && manifest->find("example");
+	});
+
+	assert(example_path_it != plugs.end());
+
+	const auto example_path = *example_path_it;
+
+	{
+		auto manifest = plugin::inspect(example_path);
+		auto example_type = manifest->find("example");
+
+		assert(manifest->find(meta::type_id<example>) == example_type);
+		assert(example_type->size == sizeof(example) && example_type->alignment == alignof(example) && !example_type->is_enum);
+		assert(example_type->num_attributes == 1);
+		assert((example_type->attribute("my::attrib") == std::vector<std::string_view>{ "1", "\"2\"", "3.0" }));
+		assert(!example_type->attribute("my::other"));
+	}
+
+	{
+		// arguments are counted, so an empty one doesn't end the list
+		plugin::manifest_type type{};
+		type.num_attributes = 2;
+		type.attributes = "first\0\3" "a\0\0b\0" "second\0\0"sv;
+
+		assert((type.attribute("first") == std::vector<std::string_view>{ "a", "", "b" }));
+		assert(type.attribute("second") && type.attribute("second")->empty());
+		assert(!type.attribute("third"));
 	}
 
+	{
+		// a sidecar older than the plugin was made for a previous build and is ignored
+		const auto dir = fs::temp_directory_path() / "metacpp-loader-test";
+		fs::create_directories(dir);
+
+		const auto copy_path = dir / example_path.filename();
+		fs::copy_file(example_path, copy_path, fs::copy_options::overwrite_existing);
+
+		auto sidecar_path = copy_path;
+		sidecar_path += plugin::manifest_extension;
+
+		{
+			// no records, so a manifest read from it lists nothing
+			std::ofstream sidecar(sidecar_path, std::ios::binary);
+			sidecar << std::string(64, '\0');
+		}
+
+		fs::last_write_time(sidecar_path, fs::last_write_time(copy_path) - std::chrono::hours(1));
+
+		auto stale = plugin::inspect(copy_path);
+		assert(stale && stale->find("example"));
+
+		fs::last_write_time(sidecar_path, fs::last_write_time(copy_path) + std::chrono::hours(1));
+
+		auto fresh = plugin::inspect(copy_path);
+		assert(fresh && !fresh->find("example"));
+
+		// records too small to hold their own header or not 8 byte aligned stop the read instead of hanging or overrunning
+		for(std::uint32_t record_size : { 0u, 8u, std::uint32_t(sizeof(refl::detail::manifest_record) + 4) }){
+			refl::detail::manifest_record rec{};
+			rec.magic = refl::detail::manifest_magic;
+			rec.record_size = record_size;
+			rec.name_size = 7;
+
+			{
+				std::ofstream sidecar(sidecar_path, std::ios::binary);
+				sidecar.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+				sidecar << std::string(64, '\0');
+			}
+
+			fs::last_write_time(sidecar_path, fs::last_write_time(copy_path) + std::chrono::hours(1));
+
+			auto corrupt = plugin::inspect(copy_path);
+			assert(corrupt && corrupt->types().empty());
+		}
+
+		fs::remove_all(dir);
+	}
+
+	// the host reflects the same header, so its registration is overridden by the plugin's
+	auto host_example_cls = refl::reflect_class("example");
+	assert(host_example_cls);
+
+	auto libs = plugin::load_all(plugs);
+
+	assert(libs.size() == plugs.size());
+
 	refl::class_info example_cls;
 	assert(example_cls = refl::reflect_class("example"));
+	assert(example_cls != host_example_cls);
 
 	assert(
 		(refl::attribute(example_cls, "my::attrib") == std::vector<std::string_view>{ "1", "\"2\"", "3.0" })
@@ -63,5 +187,133 @@ int main(int argc, char *argv[]){
 
 	assert(refl::has_base(derived_cls, base_cls));
 
+	const auto exports_type = [](const plugin::library *lib, std::string_view name){
+		return lib && std::any_of(
+			lib->exported_types().begin(), lib->exported_types().end(),
+			[name](auto type){ return type->name() == name; }
+		);
+	};
+
+	{
+		// built against another layout of a class this program already registered
+		const fs::path mismatch_path = LAYOUT_MISMATCH_PLUGIN;
+
+		auto layout_cls = refl::reflect<layout_example>();
+		assert(layout_cls && layout_cls->layout_fingerprint() == meta::layout_fingerprint<layout_example>);
+
+		{
+			auto manifest = plugin::inspect(mismatch_path);
+			assert(manifest && manifest->find(meta::type_id<layout_example>));
+			assert(manifest->find(meta::type_id<layout_example>)->layout_fingerprint != layout_cls->layout_fingerprint());
+		}
+
+		// rejected by default
+		assert(!plugin::load(mismatch_path));
+		assert(refl::reflect<layout_example>() == layout_cls);
+
+		plugin::set_layout_check(plugin::layout_check::warn);
+
+		auto warned_lib = plugin::load(mismatch_path);
+		assert(exports_type(warned_lib, "layout_example"));
+
+		auto warned_cls = refl::reflect_class("layout_example");
+		assert(warned_cls && warned_cls != layout_cls);
+
+		// a reload is compared against this program's layout, not the library it replaces, and changes nothing when rejected
+		plugin::set_layout_check(plugin::layout_check::reject);
+		assert(!plugin::reload(mismatch_path));
+		assert(refl::reflect_class("layout_example") == warned_cls);
+
+		plugin::set_layout_check(plugin::layout_check::warn);
+		assert(plugin::unload(warned_lib));
+
+		plugin::set_layout_check(plugin::layout_check::ignore);
+
+		auto ignored_lib = plugin::load(mismatch_path);
+		assert(exports_type(ignored_lib, "layout_example"));
+		assert(plugin::unload(ignored_lib));
+
+		plugin::set_layout_check(plugin::layout_check::reject);
+
+		assert(!plugin::load(mismatch_path));
+		assert(refl::reflect<layout_example>() == layout_cls);
+	}
+
+	{
+		plugin::reader_guard guard;
+
+		auto example_lib = std::find_if(libs.begin(), libs.end(), [&](auto lib){ return exports_type(lib, "example"); });
+
+		assert(example_lib != libs.end());
+
+		{
+			// the first reader loads the symbol table, the others wait for it
+			std::vector<const std::vector<std::string>*> symbol_lists(4, nullptr);
+			std::vector<std::thread> threads;
+
+			for(std::size_t i = 0; i < symbol_lists.size(); i++){
+				threads.emplace_back([&symbol_lists, i, lib = *example_lib]{ symbol_lists[i] = &lib->symbols(); });
+			}
+
+			for(auto &&thread : threads){
+				thread.join();
+			}
+
+			assert(!symbol_lists[0]->empty());
+			assert(std::all_of(symbol_lists.begin(), symbol_lists.end(), [&](auto list){ return list == symbol_lists[0]; }));
+		}
+
+		// only the reflection statics are hidden, anything else the plugin exports stays visible
+		auto &&example_symbols = (*example_lib)->symbols();
+		assert((*example_lib)->get_symbol("example_plugin_version"));
+		assert(std::find(example_symbols.begin(), example_symbols.end(), "example_plugin_version") != example_symbols.end());
+
+		// linked in from an object library, so its tables aren't listed by the plugin's entry point
+		assert(exports_type(*example_lib, "static_example") && refl::reflect_class("static_example"));
+
+		auto static_cls = refl::reflect<static_example>();
+		assert(static_cls && static_cls == refl::reflect_class("static_example"));
+
+		auto reloaded_lib = plugin::reload(plugs[example_lib - libs.begin()]);
+		assert(reloaded_lib && exports_type(reloaded_lib, "static_example"));
+
+		// the reloaded plugin constructs its own entities instead of sharing the old library's
+		assert(refl::reflect_class("example") && refl::reflect_class("example") != example_cls);
+		assert(refl::reflect<static_example>() && refl::reflect<static_example>() != static_cls);
+
+		// still mapped while the guard is alive
+		assert(example_cls->name() == "example");
+	}
+
+	{
+		// export functions never run under the registry lock, so lookups racing reloads can't deadlock
+		std::atomic_bool done = false;
+		std::vector<std::thread> readers;
+
+		for(std::size_t i = 0; i < 4; i++){
+			readers.emplace_back([&done]{
+				while(!done){
+					plugin::reader_guard guard;
+					assert(refl::reflect_class("example") && refl::reflect_class("static_example"));
+					assert(!refl::reflect_all_classes().empty());
+				}
+			});
+		}
+
+		for(std::size_t i = 0; i < 8; i++){
+			assert(plugin::reload(example_path));
+		}
+
+		done = true;
+
+		for(auto &&reader : readers){
+			reader.join();
+		}
+	}
+
+	// the registration the plugin overrode takes its place again
+	assert(plugin::unload(plugin::reload(example_path)));
+	assert(refl::reflect_class("example") == host_example_cls && refl::reflect<example>() == host_example_cls);
+
 	return 0;
 }
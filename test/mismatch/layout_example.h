@@ -0,0 +1,19 @@
+/*
+ * Meta C++ Tool and Library
+ * Copyright (C) 2022  Keith Hammond
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "metacpp/meta.hpp"
+
+// test/layout_example.h with an extra member, so its layout fingerprint differs
+class layout_example{
+	public:
+		int value = 0;
+		double scale = 1.0;
+};
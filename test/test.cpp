@@ -7,10 +7,23 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <cassert>
 #include <string_view>
 #include <filesystem>
+#include <limits>
+#include <memory_resource>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "fmt/format.h"
 
@@ -18,6 +31,8 @@
 #include "metacpp/ast.hpp"
 #include "metacpp/refl.hpp"
 #include "metacpp/serial.hpp"
+#include "metacpp/format.hpp"
+#include "metacpp/log.hpp"
 
 #include "test.hpp"
 #include "test.meta.hpp"
@@ -31,6 +46,43 @@ template<typename Str, typename ... Args>
 	std::exit(EXIT_FAILURE);
 }
 
+static std::size_t test_num_allocs = 0;
+
+template<typename T>
+struct test_counting_alloc{
+	using value_type = T;
+
+	test_counting_alloc() = default;
+
+	template<typename U>
+	test_counting_alloc(const test_counting_alloc<U>&) noexcept{}
+
+	T *allocate(std::size_t n){ ++test_num_allocs; return std::allocator<T>().allocate(n); }
+	void deallocate(T *p, std::size_t n) noexcept{ --test_num_allocs; std::allocator<T>().deallocate(p, n); }
+
+	template<typename U>
+	bool operator==(const test_counting_alloc<U>&) const noexcept{ return true; }
+
+	template<typename U>
+	bool operator!=(const test_counting_alloc<U>&) const noexcept{ return false; }
+};
+
+struct test_counting_resource: std::pmr::memory_resource{
+	std::size_t num_bytes = 0;
+
+	void *do_allocate(std::size_t bytes, std::size_t align) override{
+		num_bytes += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, align);
+	}
+
+	void do_deallocate(void *p, std::size_t bytes, std::size_t align) override{
+		num_bytes -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override{ return this == &other; }
+};
+
 int main(int argc, char *argv[]){
 	fs::path exe_path = fs::absolute(argv[0]);
 
@@ -65,6 +117,11 @@ int main(int argc, char *argv[]){
 		exit_with_error("Failed to reflect '{}'", meta::type_name<test::TestClassNS>);
 	}
 
+	// found by searching the exported tables, nothing has materialized these yet
+	assert(refl::reflect_function("testPtrFn").size() == 1 && refl::reflect_function("::testPtrFn") == refl::reflect_function("testPtrFn"));
+	assert(refl::reflect_by_id(meta::type_id<TestClass>) && refl::reflect_by_id(meta::type_id<TestClass>) == refl::reflect(typeid(TestClass)));
+	assert(refl::reflect(typeid(TestStreamV2)) && refl::reflect(typeid(TestStreamV2))->name() == "TestStreamV2");
+
 	using test_info = meta::class_info<test::TestClassNS>;
 	using test_attribs = meta::attributes<TestClass2Attribs>;
 
@@ -75,13 +132,543 @@ int main(int argc, char *argv[]){
 	test_val.m_1 = 420.f;
 
 	assert(serial::to_json(test_val) == R"({"TestClass":[{"member":{"name":"m_0","type":"int","value":"69"}},{"member":{"name":"m_1","type":"float","value":"420"}}]})");
+	assert(serial::to_json(test_val, serial::json_layout::compact) == R"({"m_0":69,"m_1":420})");
+	assert(fmt::format("{}", test_val) == "{m_0=69, m_1=420}");
+
+	assert(fmt::format("{}", TestEnum::b) == "b" && fmt::format("{:v}", TestEnum::b) == "TestEnum::b");
+	assert(fmt::format("{}", static_cast<TestEnum>(1000)) == "1000");
+
+	TestSerialClass test_fmt_val;
+	test_fmt_val.name = "n";
+	test_fmt_val.values = { 1, 2 };
+	test_fmt_val.nested = { { "x", TestEnum::b } };
+	test_fmt_val.arr = { 1, 2, 3 };
+	test_fmt_val.kind = TestEnum::a;
+
+	assert(fmt::format("{}", test_fmt_val) == "{name=n, values=[1, 2], nested=[{label=x, kind=b}], arr=[1, 2, 3], weight=none, kind=a}");
+
+	test_fmt_val.weight = 0.5;
+	assert(fmt::format("{:v}", test_fmt_val) == R"(TestSerialClass{name="n", values=[1, 2], nested=[TestSerialNested{label="x", kind=TestEnum::b}], arr=[1, 2, 3], weight=0.5, kind=TestEnum::a})");
+	assert(fmt::format("{:v}", test_fmt_val.nested[0]) == R"(TestSerialNested{label="x", kind=TestEnum::b})");
+
+	std::string test_log_line;
+	{
+		serial::logger test_log([&](std::string_view line){ test_log_line = line; }, 1024, false);
+		assert(test_log.log("val={} n={}", test_val, 1) && test_log.drain() == 1);
+		assert(test_log_line == "val={m_0=69, m_1=420} n=1");
+
+		assert(test_log.log("pi={:.2f} hex={:x} w={:>4} f={:.3}", 3.14159, 255, 7u, 2.71828f) && test_log.drain() == 1);
+		assert(test_log_line == "pi=3.14 hex=ff w=   7 f=2.72");
+
+		// rings of exited threads are dropped once drained
+		assert(test_log.num_rings() == 1);
+
+		for(int i = 0; i < 4; i++){
+			std::thread([&]{ assert(test_log.log("i={}", i)); }).join();
+		}
+
+		assert(test_log.num_rings() == 5);
+		assert(test_log.drain() == 4 && test_log_line == "i=3" && test_log.num_rings() == 1);
+	}
+
+	{
+		// an idle background thread sleeps until a record arrives
+		std::atomic<int> test_num_lines = 0;
+		serial::logger test_log([&](std::string_view){ ++test_num_lines; });
+
+		for(int i = 0; i < 3; i++){
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			assert(test_log.log("i={}", i));
+
+			while(test_num_lines.load() <= i){
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	assert(serial::from_json<TestClass>(R"({"m_1":1.5,"m_0":-2})").m_1 == 1.5f);
+	assert(serial::from_json<TestClass>(serial::to_json(test_val)).m_0 == 69);
+
+	{
+		// the verbose layout writes bools and characters the way operator<< did, the compact layout as JSON values
+		TestJsonScalars test_scalars{ true, 'x', 0.1 };
+
+		const auto test_scalars_verbose = serial::to_json(test_scalars);
+		const auto test_scalars_compact = serial::to_json(test_scalars, serial::json_layout::compact);
+
+		assert(test_scalars_verbose == R"({"TestJsonScalars":[{"member":{"name":"enabled","type":"bool","value":"1"}},{"member":{"name":"code","type":"char","value":"x"}},{"member":{"name":"ratio","type":"double","value":"0.1"}}]})");
+		assert(test_scalars_compact == R"({"enabled":true,"code":120,"ratio":0.1})");
+
+		for(auto &&json : { test_scalars_verbose, test_scalars_compact }){
+			const auto test_scalars_read = serial::from_json<TestJsonScalars>(json);
+			assert(test_scalars_read.enabled && test_scalars_read.code == 'x' && test_scalars_read.ratio == 0.1);
+		}
+
+		test_scalars = { false, '"', -2.0 };
+		const auto test_scalars_quoted = serial::from_json<TestJsonScalars>(serial::to_json(test_scalars));
+		assert(!test_scalars_quoted.enabled && test_scalars_quoted.code == '"' && test_scalars_quoted.ratio == -2.0);
+
+		// non-finite values are written as null and read back as NaN
+		test_scalars.ratio = std::numeric_limits<double>::infinity();
+
+		for(auto layout : { serial::json_layout::verbose, serial::json_layout::compact }){
+			const auto test_scalars_null = serial::from_json<TestJsonScalars>(serial::to_json(test_scalars, layout));
+			assert(std::isnan(test_scalars_null.ratio) && test_scalars_null.code == '"');
+		}
+	}
+
+	unsigned char test_binary[16];
+	auto test_binary_size = serial::to_binary(test_val, test_binary, sizeof(test_binary));
+	assert(test_binary_size && *test_binary_size == serial::binary_size(test_val));
+
+	TestClass test_binary_val;
+	assert(serial::from_binary(test_binary, *test_binary_size, test_binary_val) == test_binary_size);
+	assert(test_binary_val.m_0 == 69 && test_binary_val.m_1 == 420.f);
+
+	auto test_plan = serial::plan::get(dynamic_cast<refl::class_info>(refl::reflect<TestClass>()));
+	unsigned char test_plan_binary[16];
+	assert(test_plan && test_plan->to_binary(&test_val, test_plan_binary, sizeof(test_plan_binary)) == test_binary_size);
+	assert(std::memcmp(test_plan_binary, test_binary, *test_binary_size) == 0);
+
+	{
+		// bools are checked when read, like from_binary does
+		auto scalars_plan = serial::plan::get(dynamic_cast<refl::class_info>(refl::reflect<TestJsonScalars>()));
+		assert(scalars_plan && scalars_plan->ops().front().kind == serial::plan::op_kind::bool_);
+
+		const TestJsonScalars test_scalars_val{ true, 'x', 0.5 };
+
+		unsigned char scalars_binary[16];
+		const auto scalars_size = scalars_plan->to_binary(&test_scalars_val, scalars_binary, sizeof(scalars_binary));
+		assert(scalars_size && scalars_size == serial::binary_size(test_scalars_val));
+
+		TestJsonScalars scalars_read{};
+		assert(scalars_plan->from_binary(scalars_binary, *scalars_size, &scalars_read) == scalars_size);
+		assert(scalars_read.enabled && scalars_read.code == 'x');
+
+		scalars_binary[0] = 2;
+		assert(!scalars_plan->from_binary(scalars_binary, *scalars_size, &scalars_read));
+		assert(!serial::from_binary(scalars_binary, *scalars_size, scalars_read));
+	}
+
+	serial::gather_sink test_sink;
+	assert(test_sink.write(test_val) && test_sink.size() == *test_binary_size && test_sink.segments().size() == 1);
+
+	{
+		const auto test_gathered = [](const serial::gather_sink &sink){
+			std::vector<unsigned char> ret;
+			for(auto &&seg : sink.segments()){
+				ret.insert(ret.end(), seg.data, seg.data + seg.size);
+			}
+			return ret;
+		};
+
+		const auto test_encoded = [](const auto &val){
+			std::vector<unsigned char> ret(serial::binary_size(val));
+			assert(serial::to_binary(val, ret.data(), ret.size()) == ret.size());
+			return ret;
+		};
+
+		// runs below the threshold are copied next to the length prefixes, runs reaching it are referenced
+		serial::gather_sink test_small_sink(64);
+		const std::string test_short(63, 'a'), test_long(64, 'b');
+		assert(test_small_sink.write(test_short) && test_small_sink.write(test_long));
+		assert(test_small_sink.size() == 1 + 63 + 1 + 64 && test_small_sink.segments().size() == 2);
+		assert(test_small_sink.segments()[1].data == reinterpret_cast<const unsigned char*>(test_long.data()));
+
+		auto test_expected = test_encoded(test_short);
+		const auto test_long_bytes = test_encoded(test_long);
+		test_expected.insert(test_expected.end(), test_long_bytes.begin(), test_long_bytes.end());
+		assert(test_gathered(test_small_sink) == test_expected);
+
+		// the enum of the second element can't be encoded, which drops the referenced label of the first too
+		const std::vector<TestSerialNested> test_bad = { { std::string(100, 'c'), TestEnum::a }, { "d", static_cast<TestEnum>(0x10000) } };
+		assert(!test_small_sink.write(test_bad));
+		assert(test_small_sink.size() == test_expected.size() && test_small_sink.segments().size() == 2);
+		assert(test_gathered(test_small_sink) == test_expected);
+
+		assert(test_small_sink.write(test_short));
+		const auto test_short_bytes = test_encoded(test_short);
+		test_expected.insert(test_expected.end(), test_short_bytes.begin(), test_short_bytes.end());
+		assert(test_gathered(test_small_sink) == test_expected && test_small_sink.size() == test_expected.size());
+
+#ifndef _WIN32
+		// more than a pipe holds, so flush stops at EAGAIN and the next one resumes where it left off
+		std::vector<std::uint8_t> test_big(1 << 20);
+		for(std::size_t i = 0; i < test_big.size(); i++){
+			test_big[i] = static_cast<std::uint8_t>(i * 7);
+		}
+
+		const auto test_big_bytes = test_encoded(test_big);
+
+		serial::gather_sink test_big_sink;
+		assert(test_big_sink.write(test_big) && test_big_sink.size() == test_big_bytes.size());
+		assert(test_big_sink.segments().size() == 2 && test_big_sink.segments()[1].data == test_big.data());
+
+		int test_pipe[2];
+		assert(::pipe(test_pipe) == 0);
+		assert(::fcntl(test_pipe[1], F_SETFL, ::fcntl(test_pipe[1], F_GETFL) | O_NONBLOCK) == 0);
+
+		std::vector<unsigned char> test_received;
+		const auto test_receive = [&]{
+			unsigned char buf[65536];
+			const auto n = ::read(test_pipe[0], buf, sizeof(buf));
+			assert(n > 0);
+			test_received.insert(test_received.end(), buf, buf + n);
+		};
+
+		std::size_t test_num_blocked = 0;
+		while(!test_big_sink.flush(test_pipe[1])){
+			assert(errno == EAGAIN || errno == EWOULDBLOCK);
+			++test_num_blocked;
+			test_receive();
+		}
+
+		assert(test_num_blocked > 0 && test_big_sink.size() == 0 && test_big_sink.segments().empty());
+
+		while(test_received.size() < test_big_bytes.size()){
+			test_receive();
+		}
+
+		assert(test_received == test_big_bytes);
+
+		::close(test_pipe[0]);
+		::close(test_pipe[1]);
+#endif
+	}
+
+	serial::view_builder<TestClass> test_view_builder;
+	test_view_builder.add(test_val);
+	auto test_view_data = test_view_builder.finish();
+	std::vector<std::uint64_t> test_view_buffer((test_view_data.size() + 7) / 8);
+	std::memcpy(test_view_buffer.data(), test_view_data.data(), test_view_data.size());
+	auto test_view = serial::view_table<TestClass>::from_buffer(test_view_buffer.data(), test_view_data.size());
+	assert(test_view && test_view->size() == 1 && (*test_view)[0].get<0>() == 69 && (*test_view)[0].get<1>() == 420.f);
+
+	serial::binary_stream_writer<TestClass> test_stream;
+	assert(test_stream.write(test_val));
+	auto test_stream_reader = serial::binary_stream_reader<TestClass>::open(test_stream.data().data(), test_stream.data().size());
+	TestClass test_stream_val;
+	assert(test_stream_reader && test_stream_reader->is_exact() && test_stream_reader->read(test_stream_val) && test_stream_val.m_0 == 69);
+
+	{
+		TestSerialClass test_serial_val;
+		test_serial_val.id = -7;
+		test_serial_val.name = "serial";
+		test_serial_val.values = { 1, 2, 300 };
+		test_serial_val.nested = { { "a", TestEnum::b }, { "", TestEnum::count } };
+		test_serial_val.arr = { 4, 5, 6 };
+		test_serial_val.weight = 2.5;
+		test_serial_val.kind = TestEnum::_2;
+
+		const auto test_serial_check = [](const TestSerialClass &val){
+			return
+				val.id == -7 && val.name == "serial" && val.values == std::vector<std::uint16_t>{ 1, 2, 300 } &&
+				val.nested.size() == 2 && val.nested[0].label == "a" && val.nested[0].kind == TestEnum::b &&
+				val.nested[1].label.empty() && val.nested[1].kind == TestEnum::count &&
+				val.arr == std::array<std::int32_t, 3>{ 4, 5, 6 } && val.kind == TestEnum::_2;
+		};
+
+		std::vector<unsigned char> test_serial_bytes(serial::binary_size(test_serial_val));
+		assert(serial::to_binary(test_serial_val, test_serial_bytes.data(), test_serial_bytes.size()) == test_serial_bytes.size());
+
+		// the public base is written before the members of the class
+		std::int32_t test_serial_id;
+		assert(serial::from_binary(test_serial_bytes.data(), 4, test_serial_id) == 4 && test_serial_id == -7);
+
+		TestSerialClass test_serial_read;
+		assert(serial::from_binary(test_serial_bytes.data(), test_serial_bytes.size(), test_serial_read) == test_serial_bytes.size());
+		assert(test_serial_check(test_serial_read) && test_serial_read.weight == 2.5);
+
+		for(std::size_t i = 0; i < test_serial_bytes.size(); i++){
+			TestSerialClass test_serial_partial;
+			assert(!serial::from_binary(test_serial_bytes.data(), i, test_serial_partial));
+		}
+
+		test_serial_val.weight.reset();
+		test_serial_bytes.resize(serial::binary_size(test_serial_val));
+		assert(serial::to_binary(test_serial_val, test_serial_bytes.data(), test_serial_bytes.size()) == test_serial_bytes.size());
+		assert(serial::from_binary(test_serial_bytes.data(), test_serial_bytes.size(), test_serial_read) == test_serial_bytes.size());
+		assert(test_serial_check(test_serial_read) && !test_serial_read.weight);
+
+		// lengths longer than the input are rejected before anything is allocated
+		const unsigned char test_serial_corrupt[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+		std::vector<TestSerialNested> test_serial_nested;
+		std::string test_serial_str;
+		assert(!serial::from_binary(test_serial_corrupt, sizeof(test_serial_corrupt), test_serial_nested));
+		assert(!serial::from_binary(test_serial_corrupt, sizeof(test_serial_corrupt), test_serial_str));
+
+		serial::binary_stream_writer<TestSerialClass> test_serial_stream;
+		assert(test_serial_stream.write(test_serial_val));
+
+		auto test_serial_stream_reader = serial::binary_stream_reader<TestSerialClass>::open(test_serial_stream.data().data(), test_serial_stream.data().size());
+		TestSerialClass test_serial_stream_val;
+		assert(test_serial_stream_reader && test_serial_stream_reader->is_exact());
+		assert(test_serial_stream_reader->read(test_serial_stream_val) && test_serial_check(test_serial_stream_val));
+
+		// the offset of a base holding members isn't known at runtime
+		assert(!serial::plan::get(dynamic_cast<refl::class_info>(refl::reflect<TestDerived>())));
+		assert(!serial::plan::get(dynamic_cast<refl::class_info>(refl::reflect<TestDerived>())));
+	}
+
+	{
+		serial::binary_stream_writer<TestStreamV1> test_v1_stream;
+		assert(test_v1_stream.write(TestStreamV1{ -300, "first", 1.5f, 7, 5, TestEnum::c }));
+		assert(test_v1_stream.write(TestStreamV1{ 12, "", -0.25f, 8, std::nullopt, TestEnum::_1 }));
+
+		auto &&test_v1_data = test_v1_stream.data();
+
+		// reordered, widened and optional-wrapped members are converted, removed ones skipped and added ones left alone
+		auto test_v2_reader = serial::binary_stream_reader<TestStreamV2>::open(test_v1_data.data(), test_v1_data.size());
+		assert(test_v2_reader && !test_v2_reader->is_exact());
+
+		TestStreamV2 test_v2{};
+		test_v2.added = { 1 };
+
+		assert(test_v2_reader->read(test_v2));
+		assert(test_v2.name == "first" && test_v2.count == -300 && test_v2.ratio == 1.5 && test_v2.level == 5);
+		assert(test_v2.kind == TestEnum::c && test_v2.added == std::vector<int>{ 1 });
+
+		// values that are no longer optional keep their value when they weren't written
+		test_v2.level = -1;
+		assert(test_v2_reader->read(test_v2) && test_v2.name.empty() && test_v2.count == 12 && test_v2.ratio == -0.25);
+		assert(test_v2.level == -1 && test_v2.kind == TestEnum::_1);
+		assert(test_v2_reader->at_end() && !test_v2_reader->read(test_v2));
+
+		{
+			// narrowed integers keep their value when the written one doesn't fit
+			serial::binary_stream_writer<TestStreamV2> test_wide_stream;
+			assert(test_wide_stream.write(TestStreamV2{ "wide", 100000, 0.5, 3, TestEnum::a, {} }));
+			assert(test_wide_stream.write(TestStreamV2{ "narrow", -300, 0.5, 3, TestEnum::a, {} }));
+
+			auto test_narrow_reader = serial::binary_stream_reader<TestStreamV1>::open(test_wide_stream.data().data(), test_wide_stream.data().size());
+			assert(test_narrow_reader);
+
+			TestStreamV1 test_narrow{};
+			test_narrow.count = 1;
+
+			assert(test_narrow_reader->read(test_narrow) && test_narrow.name == "wide" && test_narrow.count == 1);
+			assert(test_narrow_reader->read(test_narrow) && test_narrow.name == "narrow" && test_narrow.count == -300);
+		}
+
+		// magic, version, fingerprint and a one byte schema size come before the schema
+		const std::size_t test_schema_offset = 4 + 1 + 8 + 1;
+		assert(test_v1_data[test_schema_offset - 1] < 0x80);
+
+		const std::size_t test_records_offset = test_schema_offset + test_v1_data[test_schema_offset - 1];
+
+		for(std::size_t i = 0; i < test_v1_data.size(); i++){
+			auto test_truncated = serial::binary_stream_reader<TestStreamV2>::open(test_v1_data.data(), i);
+			assert(bool(test_truncated) == (i >= test_records_offset));
+
+			TestStreamV2 test_truncated_val{};
+			assert(!test_truncated || !(test_truncated->read(test_truncated_val) && test_truncated->read(test_truncated_val)));
+		}
+
+		const auto test_corrupt_open = [&](std::size_t offset, unsigned char byte){
+			auto test_corrupt = test_v1_data;
+			test_corrupt[offset] = byte;
+			return serial::binary_stream_reader<TestStreamV2>::open(test_corrupt.data(), test_corrupt.size());
+		};
+
+		// an unknown type code, a field count past the end of the schema and a schema size that doesn't match the schema
+		assert(!test_corrupt_open(test_schema_offset, 0xff));
+		assert(!test_corrupt_open(test_schema_offset + 1, 0x7f));
+		assert(!test_corrupt_open(test_schema_offset - 1, 0x7f));
+	}
 
 	using namespace std::string_view_literals;
 
 	assert(test_cls && "could not cast to refl::class_info");
 
 	assert(test_info::name == test_type->name());
+	assert(refl::reflect(typeid(test::TestClassNS)) == test_type);
+	assert(refl::reflect_by_id(meta::type_id<test::TestClassNS>) == test_type);
 	assert(test_info::methods::size == test_cls->num_methods());
+	assert(test_info::layout_fingerprint == test_cls->layout_fingerprint());
+
+	const auto find_test_method = [test_cls](std::string_view name) -> refl::class_method_info{
+		for(std::size_t i = 0; i < test_cls->num_methods(); i++){
+			if(test_cls->method(i)->name() == name){
+				return test_cls->method(i);
+			}
+		}
+
+		return nullptr;
+	};
+
+	auto test_method2 = find_test_method("test_member2");
+	auto test_method3 = find_test_method("test_member3");
+
+	assert(test_method2 && !test_method2->is_static());
+	assert(test_method3);
+
+	test::TestClassNS test_ns_val;
+	assert(refl::invoke<float>(test_method2, test_ns_val, 1.f, 2.f) == 3.f);
+
+	int test_int = 2;
+	const char *test_str = "abcd";
+	assert(refl::invoke<std::size_t>(test_method3, test_ns_val, "abc", &test_int) == 5);
+	assert(refl::invoke<std::size_t>(test_method3, &test_ns_val, test_str, nullptr) == 4);
+
+	assert(refl::reflect<int>()->size() == sizeof(int));
+	assert(refl::reflect<int>()->is_trivially_relocatable());
+
+	refl::value<> test_value(meta::type<TestClass>{}, test_val);
+	refl::value<> test_value_copy = test_value;
+	assert(test_value_copy.as<TestClass>()->m_0 == 69);
+	assert(test_value.hash() == test_value_copy.hash() && test_value.hash() == std::hash<refl::value<>>{}(test_value_copy));
+	assert(test_value.type()->hash(&test_val) == meta::hash<TestClass>{}(test_val));
+
+	// public bases are hashed along with the members, const members count as their plain type
+	static_assert(meta::is_hashable<TestSerialClass> && meta::is_hashable<TestGatherClass>);
+
+	TestSerialClass test_hash_val{};
+	test_hash_val.id = 1;
+	test_hash_val.name = "n";
+	test_hash_val.kind = TestEnum::a;
+
+	TestSerialClass test_hash_other = test_hash_val;
+	assert(meta::hash<TestSerialClass>{}(test_hash_val) == meta::hash<TestSerialClass>{}(test_hash_other));
+
+	test_hash_other.id = 2;
+	assert(meta::hash<TestSerialClass>{}(test_hash_val) != meta::hash<TestSerialClass>{}(test_hash_other));
+
+	const TestGatherClass test_hash_gather{ "a", 1, 0.5, 2 }, test_hash_gather_other{ "b", 1, 0.5, 2 };
+	assert(meta::hash<TestGatherClass>{}(test_hash_gather) != meta::hash<TestGatherClass>{}(test_hash_gather_other));
+
+	static_assert(meta::is_hashable<TestTreeNode>);
+
+	const TestTreeNode test_tree{ 1, { { 2, {} }, { 3, { { 4, {} } } } } };
+	TestTreeNode test_tree_other = test_tree;
+	assert(meta::hash<TestTreeNode>{}(test_tree) == meta::hash<TestTreeNode>{}(test_tree_other));
+	assert(refl::reflect<TestTreeNode>()->hash(&test_tree) == meta::hash<TestTreeNode>{}(test_tree));
+
+	test_tree_other.children[1].children[0].value = 5;
+	assert(meta::hash<TestTreeNode>{}(test_tree) != meta::hash<TestTreeNode>{}(test_tree_other));
+
+	std::vector<TestGatherClass> test_gather_objs;
+	for(int i = 0; i < 19; i++){
+		test_gather_objs.push_back(TestGatherClass{ std::to_string(i), i, i * 0.5, static_cast<std::uint16_t>(i) });
+	}
+
+	auto test_gather_cls = dynamic_cast<refl::class_info>(refl::reflect<TestGatherClass>());
+	assert(test_gather_cls && test_gather_cls->num_members() == 4 && test_gather_cls->member(1)->name() == "value");
+
+	const auto test_value_offset = reinterpret_cast<const unsigned char*>(&test_gather_objs[0].value) - reinterpret_cast<const unsigned char*>(&test_gather_objs[0]);
+	assert(!test_gather_cls->member(1)->is_standard_layout() || test_gather_cls->member(1)->offset() == std::size_t(test_value_offset));
+
+	// 19 elements covers both the 8/4 wide gathers and their scalar tails
+	alignas(std::string) unsigned char test_gathered_names[sizeof(std::string) * 19];
+	int test_gathered_ints[19];
+	double test_gathered_doubles[19];
+	std::uint16_t test_gathered_smalls[19];
+
+	assert(test_gather_cls->member(0)->gather(test_gather_objs.data(), sizeof(TestGatherClass), 19, test_gathered_names));
+	assert(test_gather_cls->member(1)->gather(test_gather_objs.data(), sizeof(TestGatherClass), 19, test_gathered_ints));
+	assert(test_gather_cls->member(2)->gather(test_gather_objs.data(), sizeof(TestGatherClass), 19, test_gathered_doubles));
+	assert(test_gather_cls->member(3)->gather(test_gather_objs.data(), sizeof(TestGatherClass), 19, test_gathered_smalls));
+
+	auto test_names = std::launder(reinterpret_cast<std::string*>(test_gathered_names));
+
+	for(int i = 0; i < 19; i++){
+		assert(test_names[i] == std::to_string(i) && test_gathered_ints[i] == i);
+		assert(test_gathered_doubles[i] == i * 0.5 && test_gathered_smalls[i] == i);
+	}
+
+	std::destroy_n(test_names, 19);
+
+	unsigned char test_strided_src[24 * 19], test_strided_dst[24 * 19];
+	for(std::size_t i = 0; i < sizeof(test_strided_src); i++){
+		test_strided_src[i] = static_cast<unsigned char>(i);
+	}
+
+	for(std::size_t elem_size : { 1, 2, 3, 4, 8, 24 }){
+		refl::detail::strided_copy(test_strided_src, 24, 19, test_strided_dst, elem_size);
+
+		for(std::size_t i = 0; i < 19; i++){
+			assert(std::memcmp(test_strided_dst + (i * elem_size), test_strided_src + (i * 24), elem_size) == 0);
+		}
+	}
+
+	static_assert(refl::value<void, std::allocator, 64>::small_size == 64);
+	assert(test_value.is_inline());
+	assert((!refl::value<void, std::allocator, 0>(meta::type<TestClass>{}, test_val).is_inline()));
+
+	{
+		refl::value<void, test_counting_alloc, 0> test_counted(meta::type<TestClass>{}, test_val);
+		refl::value<void, test_counting_alloc, 0> test_counted_dyn(refl::reflect<TestClass>());
+		assert(test_num_allocs == 2 && test_counted.as<TestClass>()->m_0 == 69);
+
+		refl::value<void, test_counting_alloc> test_counted_inline(meta::type<TestClass>{}, test_val);
+		assert(test_num_allocs == 2 && test_counted_inline.is_inline());
+	}
+	assert(test_num_allocs == 0);
+
+	{
+		test_counting_resource test_resource;
+
+		refl::pmr::value<void, 0> test_pmr_value(std::allocator_arg, &test_resource, meta::type<TestClass>{}, test_val);
+		assert(test_resource.num_bytes >= sizeof(TestClass) && test_pmr_value.get_allocator().resource() == &test_resource);
+
+		refl::pmr::value<void, 0> test_pmr_moved = std::move(test_pmr_value);
+		assert(test_pmr_moved.get_allocator().resource() == &test_resource && test_pmr_moved.as<TestClass>()->m_1 == 420.f);
+
+		test_pmr_moved = refl::pmr::value<void, 0>();
+		assert(test_resource.num_bytes == 0);
+	}
+
+	refl::value_vector<> test_values(refl::reflect<TestClass>());
+	test_values.push_back(&test_val);
+	test_values.construct_n(2);
+	assert(test_values.size() == 3 && test_values.data_as<TestClass>()[0].m_1 == 420.f);
+
+	// an element copied into the array is read before the array grows and moves it
+	test_values.shrink_to_fit();
+
+	for(int i = 0; i < 4; i++){
+		test_values.push_back(test_values[0]);
+	}
+
+	assert(test_values.size() == 7 && test_values.data_as<TestClass>()[6].m_0 == 69 && test_values.data_as<TestClass>()[6].m_1 == 420.f);
+
+	auto test_fn = refl::reflect(&testFn);
+	assert(test_fn && refl::reflect_function("testFn").size() == 1);
+	refl::invoke<void>(test_fn, 1, test_val);
+
+	auto test_ptr_fn = refl::reflect(&testPtrFn);
+	assert(test_ptr_fn && refl::invoke<int>(test_ptr_fn, &test_int, "abc") == 5);
+	assert(refl::invoke<int>(test_ptr_fn, nullptr, test_str) == 4);
+
+	// the number of arguments is checked, so a short call can't read past them
+	try{
+		refl::invoke<int>(test_ptr_fn, &test_int);
+		assert(false);
+	}
+	catch(const std::runtime_error&){}
+
+	try{
+		refl::invoke<std::size_t>(test_method3, test_ns_val, "abc");
+		assert(false);
+	}
+	catch(const std::runtime_error&){}
+
+	std::string test_moved_str = "moved";
+	auto test_move_fn = refl::reflect(&testMoveFn);
+	assert(test_move_fn);
+
+	std::string &&test_moved_ref = refl::invoke<std::string&&>(test_move_fn, std::move(test_moved_str));
+	assert(&test_moved_ref == &test_moved_str);
+
+	{ refl::pooled_value pooled(refl::reflect<TestClass>()); }
+	{ refl::pooled_value pooled(refl::reflect<TestClass>()); assert(pooled.as<TestClass>()); }
+	assert(refl::object_pool::local().hits() > 0);
+
+	// the value outlives the thread's pool, so its storage must not go back into the destroyed pool
+	std::thread([]{
+		thread_local refl::pooled_value test_late_value;
+		test_late_value = refl::pooled_value(refl::reflect<TestClass>());
+		assert(refl::object_pool::try_local());
+	}).join();
 
 	using attrib_results = meta::query_attribs<TestClass2Attribs, "foo", "bar">;
 	using method_results = meta::query_methods<test::TestClassNS, "test_member", void(std::string_view)>;
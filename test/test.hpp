@@ -10,16 +10,23 @@
 #ifndef TEST_TEST_HPP
 #define TEST_TEST_HPP 1
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 class TestPredefined;
 
 namespace test{
 	class TestClassNS{
 		public:
-			void test_member(std::string_view a);
+			void test_member(std::string_view a){}
 
 			float test_member2(float a, float b){ return a + b; }
+
+			std::size_t test_member3(const char *str, const int *n) const{ return std::string_view(str).size() + (n ? *n : 0); }
 	};
 }
 
@@ -40,7 +47,63 @@ class TestClass{
 		int m_0;
 		float m_1;
 
-		std::string_view f_0(std::string &str) const noexcept;
+		std::string_view f_0(std::string &str) const noexcept{ return str; }
+};
+
+struct TestGatherClass{
+	const std::string name;
+	int value;
+	double weight;
+	std::uint16_t small;
+};
+
+struct TestJsonScalars{
+	bool enabled;
+	char code;
+	double ratio;
+};
+
+struct TestSerialBase{
+	std::int32_t id;
+};
+
+struct TestSerialNested{
+	std::string label;
+	TestEnum kind;
+};
+
+struct TestSerialClass: public TestSerialBase{
+	std::string name;
+	std::vector<std::uint16_t> values;
+	std::vector<TestSerialNested> nested;
+	std::array<std::int32_t, 3> arr;
+	std::optional<double> weight;
+	TestEnum kind;
+};
+
+// holds values of its own type, which hashing has to handle without recursing forever
+struct TestTreeNode{
+	std::int32_t value;
+	std::vector<TestTreeNode> children;
+};
+
+// an older and a newer version of the same record, read across versions through a binary stream
+struct TestStreamV1{
+	std::int16_t count;
+	std::string name;
+	float ratio;
+	std::uint32_t removed;
+	std::optional<std::int32_t> level;
+	TestEnum kind;
+};
+
+struct TestStreamV2{
+	std::string name;
+	std::int64_t count;
+	std::optional<double> ratio;
+	std::int32_t level;
+	TestEnum kind;
+	std::vector<int> added;
 };
 
 class TestBase{
@@ -118,4 +181,8 @@ class [[test::predefined]] TestPredefined{};
 [[other::attrib(with, "args")]]
 inline void testFn(int a, TestClass b){}
 
+inline int testPtrFn(const int *a, const char *b){ return (a ? *a : 0) + (b ? static_cast<int>(std::string_view(b).size()) : 0); }
+
+inline std::string &&testMoveFn(std::string &&str){ return std::move(str); }
+
 #endif // !TEST_TEST_HPP